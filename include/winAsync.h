@@ -9,27 +9,29 @@
 #include <chrono>
 #include <queue>
 #include <unordered_set>
+#include <unordered_map>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <optional>
+#include <utility>
+#include <atomic>
+#include <exception>
 #include <cstdarg>
 #include <cstdio>
+#include "winAsyncLog.h"
 
 #ifdef DEBUG_COROUTINE
-inline void DebugPrint(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    vprintf(format, args);
-    va_end(args);
-    fflush(stdout);
-}
+// Goes through the async logger so debug builds keep roughly release timing under load
+#define DebugPrint(...) LOG_DEBUG(__VA_ARGS__)
 #else
 #define DebugPrint(...) ((void)0)
 #endif
 
 class Coroutine;
 class Scheduler;
+class CoreRuntime;
+class TaskGroup;
 struct ExceptionState;
 template <typename T>
 class CoroutinePromise;
@@ -41,13 +43,71 @@ void SetCurrentScheduler(Scheduler* scheduler);
 
 struct IoOperation : public OVERLAPPED {
     IoOperation();
-    Coroutine* coroutine;
+    Coroutine* coroutine;       // Resumed on completion; may be null when the owner polls 'completed'
+    DWORD bytesTransferred;
+    DWORD errorCode;
+    bool completed;
+};
+
+// Static label for a family of coroutines, e.g. `static const TaskTag kParseTag{"parse"};`.
+// Tags are compared by address and must outlive every scheduler that runs tagged work.
+struct TaskTag {
+    const char* name;
+    mutable std::atomic<uint32_t> hogReports{0};    // Bumped by HogWatchdog each time the tag overruns its slice
+};
+
+template <typename Func>
+using EnableIfNotTaskTag = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, TaskTag>>;
+
+bool ShouldOffloadTag(const TaskTag& tag);
+
+// Why a coroutine that is not running is waiting
+enum class WaitKind : uint8_t {
+    Ready,      // Runnable, queued behind other coroutines
+    Timer,      // AsyncSleep
+    Io,         // Parked in SuspendExecution until a completion resumes it
+    Pool,       // Queued on the thread pool before a worker picked it up
+    Count
+};
+
+// Per-scheduler counters for one tag. Only the owning thread writes; snapshots read from any thread.
+struct TagStats {
+    static constexpr size_t kSliceBuckets = 24;     // Bucket i holds slices shorter than 2^i microseconds
+    static constexpr size_t kWaitKinds = static_cast<size_t>(WaitKind::Count);
+    std::atomic<uint64_t> sliceBuckets[kSliceBuckets] = {};
+    std::atomic<uint64_t> maxSliceTicks{0};
+    std::atomic<uint64_t> cpuTicks{0};
+    std::atomic<uint64_t> waitTicks[kWaitKinds] = {};
 };
 
 void CaptureException(ExceptionState* es, const EXCEPTION_RECORD& record);
+std::shared_ptr<ExceptionState> MakeExceptionState(std::exception_ptr error);
+std::shared_ptr<ExceptionState> MakeExceptionSlot();
 bool HasException(const ExceptionState* es);
 void RethrowIfExists(const ExceptionState* es);
 
+enum class IdlePolicy {
+    Block,          // Park in GetQueuedCompletionStatus as soon as nothing is runnable
+    SpinThenPark,   // Poll for an adaptively tuned number of microseconds, then park
+    BusyPoll        // Never park; intended for threads that own a dedicated core
+};
+
+struct ThreadPoolOptions {
+    size_t minThreads = 0;                              // 0 = hardware_concurrency()
+    size_t maxThreads = 0;                              // 0 = 4 * minThreads; blocked workers do not count
+    size_t maxBlockingThreads = 64;                     // Extra workers allowed to compensate for BlockingRegion
+    size_t maxQueueLength = 0;                          // 0 = unbounded; otherwise Submit waits for space
+    std::chrono::milliseconds growthLatency{10};        // Queue wait that triggers spawning another worker
+    std::chrono::milliseconds idleTimeout{5000};        // Idle time after which workers above minThreads retire
+};
+
+// Coroutines placed in a TaskGroup arena are only destroyed here; the group frees their memory
+struct CoroutineDeleter {
+    void operator()(Coroutine* co) const;
+};
+
+using CoroutinePtr = std::unique_ptr<Coroutine, CoroutineDeleter>;
+
 class Coroutine {
 public:
     enum class State { Ready, Running, Suspended, Finished };
@@ -63,50 +123,188 @@ public:
 
 private:
     friend class Scheduler;
+    friend class TaskGroup;
+    friend struct CoroutineDeleter;
     friend void CoroutineTrampoline(void* arg);
 
+    // Set by the scheduler before the first resume, so the VEH only fills it in and never allocates
+    ExceptionState* ExceptionSlot();
+
     std::function<void()> func;
     std::function<void(std::shared_ptr<ExceptionState>)> onDone;
     State state;
     Scheduler* scheduler;
-    void* fiber = nullptr;
+    void* fiber = nullptr;                  // Taken from the scheduler on first resume, returned when finished
     std::shared_ptr<ExceptionState> exceptionState;
     std::shared_ptr<void> promiseHandle;
+    const TaskTag* tag = nullptr;
+    TagStats* stats = nullptr;
+    WaitKind waitKind = WaitKind::Ready;
+    uint64_t waitStartTicks = 0;
+    bool arenaOwned = false;
 };
 
 class Scheduler {
 public:
     Scheduler();
     explicit Scheduler(size_t numThreads);
+    explicit Scheduler(const ThreadPoolOptions& options);
     ~Scheduler();
 
-    void Add(std::function<void()> func);
-    void Submit(std::function<void()> func);
+    void Add(std::function<void()> func, const TaskTag* tag = nullptr, std::function<void(std::shared_ptr<ExceptionState>)> onDone = nullptr);
+    void Post(std::function<void()> func);
+
+    // Submit waits for queue space and TrySubmit fails instead; both throw once the pool has stopped.
+    // A worker of this pool never waits on its own full queue: Submit runs func on that worker instead.
+    // onDone runs on the worker once func has finished, with the exception it threw if any
+    void Submit(std::function<void()> func, const TaskTag* tag = nullptr, std::function<void(std::shared_ptr<ExceptionState>)> onDone = nullptr);
+    bool TrySubmit(std::function<void()>& func, const TaskTag* tag = nullptr);
+    void Configure(const ThreadPoolOptions& options);
+    size_t PendingTasks() const;
+    size_t WorkerCount();
     void Run();
     void Stop();
     void RegisterHandle(HANDLE handle);
+    void PostCompletion(IoOperation* op);
+    void SetIdlePolicy(IdlePolicy policy, uint32_t maxSpinMicroseconds = 50);
+    IdlePolicy GetIdlePolicy() const;
     void Resume(Coroutine* co);
     Coroutine* PollException();
     Coroutine* GetRunningCoroutine() const;
     static void AsyncSleep(uint32_t milliseconds);
 
-    template <typename T, typename Func, typename... Args>
+    template <typename T, typename Func, typename = EnableIfNotTaskTag<Func>, typename... Args>
     std::shared_ptr<CoroutinePromise<T>> CreateCoroutine(Func&& func, Args&&... args);
 
+    template <typename T, typename Func, typename... Args>
+    std::shared_ptr<CoroutinePromise<T>> CreateCoroutine(const TaskTag& tag, Func&& func, Args&&... args);
+
+    // Visits this scheduler's per-tag counters; safe to call from any thread
+    template <typename Visitor>
+    void ForEachTagStats(Visitor&& visit) {
+        std::lock_guard<std::mutex> lock(tagStatsMutex);
+        for (const auto& entry : tagStats) {
+            visit(entry.first, *entry.second);
+        }
+    }
+
 private:
+    template <typename T, typename Callable>
+    void Launch(std::shared_ptr<CoroutinePromise<T>> promise, Callable task, const TaskTag* tag = nullptr);
+
+    // Published around every resume so a HogWatchdog thread can spot coroutines that do not yield
+    struct RunSlot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint64_t> resumeTicks{0};
+        std::atomic<const TaskTag*> tag{nullptr};
+        std::atomic<bool> running{false};
+        uint64_t reportedSequence = 0;              // Monitor thread only
+    };
+
+    // FIFO of runnable coroutines on a growable power-of-two ring, so bulk spawns can reserve once
+    class RunnableRing {
+    public:
+        void Push(Coroutine* co) {
+            if (tail - head == slots.size()) {
+                Grow(slots.size() + 1);
+            }
+            slots[tail++ & (slots.size() - 1)] = co;
+        }
+        Coroutine* Pop() { return head == tail ? nullptr : slots[head++ & (slots.size() - 1)]; }
+        bool Empty() const { return head == tail; }
+        size_t Size() const { return tail - head; }
+        void Reserve(size_t capacity) {
+            if (capacity > slots.size()) {
+                Grow(capacity);
+            }
+        }
+    private:
+        void Grow(size_t minimum);
+        std::vector<Coroutine*> slots;
+        size_t head = 0;
+        size_t tail = 0;
+    };
+
+    // Tracks how long idle periods last and derives how long it is worth spinning before parking
+    class IdleSpinTuner {
+    public:
+        void Record(std::chrono::steady_clock::duration idleTime);
+        std::chrono::microseconds Budget(uint32_t maxSpinMicroseconds) const;
+    private:
+        double averageIdleMicroseconds = 0.0;
+    };
+
+    // A coroutine parked in Submit until the pool has room; woken through its own scheduler's completion port
+    struct SpaceWaiter {
+        IoOperation op;
+        Scheduler* scheduler = nullptr;
+    };
+
+    struct PoolTask {
+        std::function<void()> func;
+        std::function<void(std::shared_ptr<ExceptionState>)> onDone;
+        std::chrono::steady_clock::time_point enqueueTime;
+        const TaskTag* tag;
+    };
+
     void WorkerLoop();
+    void GrowthMonitorLoop();
+    void NotifyGrowthMonitorLocked();
+    void SpawnWorkerLocked();
+    void RetireWorkerLocked();
+    void JoinRetiredWorkers();
+    bool ShouldGrowLocked(std::chrono::steady_clock::time_point now) const;
+    bool TryEnqueue(std::function<void()>& func, const TaskTag* tag, std::function<void(std::shared_ptr<ExceptionState>)>& onDone);
+    bool QueueFullLocked() const;
+    void WakeSpaceWaitersLocked(size_t count);
+    size_t RunnableWorkersLocked() const;
+    void EnterBlocking();
+    void LeaveBlocking();
+    void DrainInbox();
+    // Queues a coroutine parked with SuspendExecution; only from this scheduler's own thread
+    void MakeRunnable(Coroutine* co) { runnableQueue.Push(co); }
+    void* AcquireFiber();
+    void RecycleFiber(Coroutine* co);
+    std::shared_ptr<ExceptionState> AcquireExceptionSlot();
+    void RecycleExceptionSlot(std::shared_ptr<ExceptionState> slot);
+    bool DequeueCompletion(DWORD timeout);
+    void WaitForEvents(DWORD timeout);
     static LONG WINAPI VectoredExceptionHandler(PEXCEPTION_POINTERS ExceptionInfo);
+    TagStats* StatsForTag(const TaskTag* tag);
+    void RecordSlice(Coroutine* co, uint64_t ticks);
+    void RecordWait(Coroutine* co, uint64_t resumeTicks);
+    void RecordPoolWait(const TaskTag* tag, std::chrono::steady_clock::duration wait);
 
     friend class Coroutine;
+    friend class HogWatchdog;
+    friend class TaskProfiler;
+    friend class CoreRuntime;
+    friend class BlockingRegion;
+    friend class TaskGroup;
+    friend void CoroutineTrampoline(void* arg);
+    template <typename> friend class Task;
+    template <typename> friend class AsyncLazy;
+    template <typename> friend class AsyncStream;
+    template <typename> friend class Generator;
+    template <typename, typename, typename> friend class SingleFlightCache;
 
     void* mainFiber;
     HANDLE iocpHandle;
     Coroutine* runningCoroutine;
-    std::vector<std::unique_ptr<Coroutine>> coroutines;
+    std::vector<CoroutinePtr> coroutines;
     void* vehHandle;
     Coroutine* pendingException;
 
-    std::deque<Coroutine*> runnableQueue;
+    RunSlot runSlot;
+    HANDLE threadHandle = nullptr;
+    DWORD threadId = 0;
+    std::mutex tagStatsMutex;
+    std::unordered_map<const TaskTag*, std::unique_ptr<TagStats>> tagStats;
+
+    RunnableRing runnableQueue;
+    static constexpr size_t kMaxIdleFibers = 64;
+    std::vector<void*> idleFibers;
+    std::vector<std::shared_ptr<ExceptionState>> idleExceptionSlots;   // Unused slots of cleanly finished coroutines
     struct TimerNode {
         std::chrono::steady_clock::time_point wakeupTime;
         Coroutine* coroutine;
@@ -115,22 +313,73 @@ private:
     std::priority_queue<TimerNode, std::vector<TimerNode>, std::greater<TimerNode>> timers;
     std::unordered_set<Coroutine*> sleepingCoroutines;
 
+    static constexpr ULONG_PTR kInboxWakeKey = 1;
+    std::mutex inboxMutex;
+    std::vector<std::function<void()>> inbox;
+    std::atomic<bool> inboxPending{false};
+
+    // Held by continuations bound to this scheduler from other threads; cleared by the destructor
+    struct PostAnchor {
+        std::mutex mutex;
+        Scheduler* scheduler;
+    };
+    std::shared_ptr<PostAnchor> postAnchor;
+
+    std::atomic<IdlePolicy> idlePolicy{IdlePolicy::Block};
+    std::atomic<uint32_t> maxSpinMicroseconds{50};
+    IdleSpinTuner idleTuner;
+
     bool isThreadPool = false;
+    ThreadPoolOptions poolOptions;
     std::vector<std::thread> workers;
-    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> retiredWorkers;
+    size_t idleWorkers = 0;
+    size_t blockedWorkers = 0;
+    std::deque<PoolTask> tasks;
+    std::atomic<size_t> queuedTasks{0};
     std::mutex queueMutex;
     std::condition_variable condition;
-    bool stop = false;
+    std::condition_variable notFull;
+    std::condition_variable monitorWake;    // Signalled when tasks queue up with no idle worker to take them
+    std::thread growthMonitor;              // Grows the pool while every worker is stuck in a long task
+    bool monitorParked = false;
+    std::deque<SpaceWaiter*> spaceWaiters;
+    std::atomic<bool> stop{false};
 
 public:
     static Scheduler& GetThreadPool();
 };
 
+// Marks a pool worker as blocked (disk, locks, ...) so the pool can spawn a compensating worker
+class BlockingRegion {
+public:
+    BlockingRegion();
+    ~BlockingRegion();
+
+    BlockingRegion(const BlockingRegion&) = delete;
+    BlockingRegion& operator=(const BlockingRegion&) = delete;
+
+private:
+    Scheduler* pool;
+};
+
 #include "winAsyncTask.h"
+#include "winAsyncCore.h"
+#include "winAsyncParallel.h"
+#include "winAsyncGenerator.h"
+#include "winAsyncFile.h"
+#include "winAsyncBasicScheduler.h"
+#include "winAsyncWatchdog.h"
+#include "winAsyncCache.h"
+#include "winAsyncTaskGroup.h"
+#include "winAsyncEvent.h"
 
 inline IoOperation::IoOperation() {
     Internal = InternalHigh = 0;
     Offset = OffsetHigh = 0;
     hEvent = nullptr;
     coroutine = nullptr;
+    bytesTransferred = 0;
+    errorCode = 0;
+    completed = false;
 }
\ No newline at end of file
@@ -0,0 +1,396 @@
+#pragma once
+
+#include "winAsync.h"
+#include <exception>
+
+// Compile-time configurable fiber loop for plain closures. Each policy decides one aspect of the loop,
+// so a purely single-threaded configuration carries no locks, atomics or timer heap.
+//
+//   RunQueuePolicy: DequeRunQueue | RingRunQueue<N>   (N = initial ring capacity; it grows when full)
+//   TimerPolicy:    NoTimers | HeapTimers
+//   SyncPolicy:     NoSync | MutexSync        (MutexSync enables cross-thread Post)
+//
+// Tasks are Spawned closures that may YieldExecution and AsyncSleep, nothing more: Task, CoroutinePromise,
+// Await and IoOperation only work on Scheduler, which remains the loop used by the rest of the library.
+
+struct DequeRunQueue {
+    template <typename Item>
+    class Queue {
+    public:
+        void Push(Item* item) { items.push_back(item); }
+        Item* Pop() {
+            if (items.empty()) {
+                return nullptr;
+            }
+            Item* item = items.front();
+            items.pop_front();
+            return item;
+        }
+        bool Empty() const { return items.empty(); }
+
+    private:
+        std::deque<Item*> items;
+    };
+};
+
+template <size_t Capacity>
+struct RingRunQueue {
+    static_assert(Capacity && (Capacity & (Capacity - 1)) == 0, "RingRunQueue capacity must be a power of two");
+
+    template <typename Item>
+    class Queue {
+    public:
+        Queue() : items(Capacity) {}
+
+        void Push(Item* item) {
+            if (tail - head == items.size()) {
+                Grow();
+            }
+            items[tail++ & (items.size() - 1)] = item;
+        }
+        Item* Pop() { return head == tail ? nullptr : items[head++ & (items.size() - 1)]; }
+        bool Empty() const { return head == tail; }
+
+    private:
+        // Doubles the ring and unrolls the live items to the front, as Scheduler's run queue does
+        void Grow() {
+            std::vector<Item*> grown(items.size() * 2);
+            size_t count = tail - head;
+            for (size_t i = 0; i < count; ++i) {
+                grown[i] = items[(head + i) & (items.size() - 1)];
+            }
+            items.swap(grown);
+            head = 0;
+            tail = count;
+        }
+
+        std::vector<Item*> items;
+        size_t head = 0;
+        size_t tail = 0;
+    };
+};
+
+struct NoTimers {
+    static constexpr bool kEnabled = false;
+
+    template <typename Item>
+    class Timers {
+    public:
+        void Clear() {}
+        bool Empty() const { return true; }
+        std::chrono::steady_clock::time_point Next() const { return std::chrono::steady_clock::time_point::max(); }
+        template <typename Func>
+        void PopDue(std::chrono::steady_clock::time_point, Func&&) {}
+    };
+};
+
+struct HeapTimers {
+    static constexpr bool kEnabled = true;
+
+    template <typename Item>
+    class Timers {
+    public:
+        void Add(std::chrono::steady_clock::time_point when, Item* item) { heap.push({when, item}); }
+        void Clear() { heap = {}; }
+        bool Empty() const { return heap.empty(); }
+        std::chrono::steady_clock::time_point Next() const { return heap.top().when; }
+
+        template <typename Func>
+        void PopDue(std::chrono::steady_clock::time_point now, Func&& onDue) {
+            while (!heap.empty() && heap.top().when <= now) {
+                Item* item = heap.top().item;
+                heap.pop();
+                onDue(item);
+            }
+        }
+
+    private:
+        struct Node {
+            std::chrono::steady_clock::time_point when;
+            Item* item;
+            bool operator>(const Node& other) const { return when > other.when; }
+        };
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> heap;
+    };
+};
+
+struct NoSync {
+    static constexpr bool kThreadSafe = false;
+
+    class Inbox {
+    public:
+        bool Pending() const { return false; }
+        template <typename Func>
+        void Drain(Func&&) {}
+
+        // Nothing can arrive from outside, so only a sleeping task's timer ends the wait
+        void Wait(DWORD timeout) {
+            if (timeout != INFINITE && timeout > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+            }
+        }
+    };
+};
+
+struct MutexSync {
+    static constexpr bool kThreadSafe = true;
+
+    class Inbox {
+    public:
+        void Push(std::function<void()> func) {
+            bool wasEmpty;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                items.push_back(std::move(func));
+                wasEmpty = !pending.exchange(true, std::memory_order_acq_rel);
+            }
+            // Only the first push after a drain can find the owner asleep in Wait
+            if (wasEmpty) {
+                WakeByAddressSingle(&pending);
+            }
+        }
+        bool Pending() const { return pending.load(std::memory_order_acquire); }
+
+        // Sleeps until the timeout or the next Push; an early return from WaitOnAddress only costs a loop pass
+        void Wait(DWORD timeout) {
+            bool notPending = false;
+            if (timeout > 0 && !Pending()) {
+                WaitOnAddress(&pending, &notPending, sizeof(notPending), timeout);
+            }
+        }
+
+        template <typename Func>
+        void Drain(Func&& onItem) {
+            if (!Pending()) {
+                return;
+            }
+            std::vector<std::function<void()>> drained;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                drained.swap(items);
+                pending.store(false, std::memory_order_release);
+            }
+            for (auto& item : drained) {
+                onItem(std::move(item));
+            }
+        }
+
+    private:
+        std::mutex mutex;
+        std::vector<std::function<void()>> items;
+        std::atomic<bool> pending{false};
+    };
+};
+
+template <typename RunQueuePolicy = DequeRunQueue, typename TimerPolicy = HeapTimers, typename SyncPolicy = MutexSync>
+class BasicScheduler {
+public:
+    BasicScheduler() {
+        if (current) {
+            throw std::runtime_error("Only one BasicScheduler of a given configuration per thread is allowed.");
+        }
+        current = this;
+        if (IsThreadAFiber()) {
+            mainFiber = GetCurrentFiber();
+        } else {
+            mainFiber = ConvertThreadToFiber(nullptr);
+            convertedThread = true;
+        }
+    }
+
+    ~BasicScheduler() {
+        for (const auto& item : items) {
+            if (item->fiber) {
+                DeleteFiber(item->fiber);
+            }
+        }
+        for (void* fiber : idleFibers) {
+            DeleteFiber(fiber);
+        }
+        if (convertedThread) {
+            ConvertFiberToThread();
+        }
+        current = nullptr;
+    }
+
+    BasicScheduler(const BasicScheduler&) = delete;
+    BasicScheduler& operator=(const BasicScheduler&) = delete;
+
+    static BasicScheduler* Current() { return current; }
+
+    template <typename Func>
+    void Spawn(Func&& func) {
+        Item* item = AcquireItem();
+        item->func = std::forward<Func>(func);
+        ++liveTasks;
+        runQueue.Push(item);
+    }
+
+    // Thread-safe hand-off of a new task from any thread
+    void Post(std::function<void()> func) {
+        static_assert(SyncPolicy::kThreadSafe, "Post requires a thread-safe SyncPolicy such as MutexSync");
+        inbox.Push(std::move(func));
+    }
+
+    static void YieldExecution() {
+        BasicScheduler* self = current;
+        if (!self || !self->running) {
+            return;
+        }
+        self->runQueue.Push(self->running);
+        SwitchToFiber(self->mainFiber);
+    }
+
+    static void AsyncSleep(uint32_t milliseconds) {
+        static_assert(TimerPolicy::kEnabled, "AsyncSleep requires a timer policy such as HeapTimers");
+        BasicScheduler* self = current;
+        if (!self || !self->running) {
+            return;
+        }
+        self->timers.Add(std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds), self->running);
+        SwitchToFiber(self->mainFiber);
+    }
+
+    void Run() {
+        while (liveTasks > 0 || inbox.Pending()) {
+            inbox.Drain([this](std::function<void()> func) { Spawn(std::move(func)); });
+            timers.PopDue(std::chrono::steady_clock::now(), [this](Item* item) { runQueue.Push(item); });
+
+            // The first failure stops the pass; whatever is still pending is abandoned below
+            while (!firstError) {
+                Item* item = runQueue.Pop();
+                if (!item) {
+                    break;
+                }
+                RunItem(item);
+            }
+
+            if (firstError) {
+                std::exception_ptr error = firstError;
+                firstError = nullptr;
+                AbandonTasks();
+                std::rethrow_exception(error);
+            }
+            if (liveTasks == 0 && !inbox.Pending()) {
+                break;
+            }
+
+            // Every live task is asleep: wait for the earliest timer, cut short by a Post
+            DWORD timeout = 0;
+            if (!inbox.Pending() && !timers.Empty()) {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(timers.Next() - std::chrono::steady_clock::now());
+                timeout = wait.count() > 0 ? static_cast<DWORD>(wait.count()) : 0;
+            }
+            inbox.Wait(timeout);
+        }
+    }
+
+private:
+    struct Item {
+        std::function<void()> func;
+        void* fiber = nullptr;
+        bool finished = false;
+        bool live = false;
+    };
+
+    Item* AcquireItem() {
+        Item* item;
+        if (freeItems.empty()) {
+            items.push_back(std::make_unique<Item>());
+            item = items.back().get();
+        } else {
+            item = freeItems.back();
+            freeItems.pop_back();
+        }
+        item->finished = false;
+        item->live = true;
+        return item;
+    }
+
+    // After a failure, drops every task that has not finished so its fiber and closure do not
+    // outlive Run. Their stacks are freed without unwinding, as with any abandoned fiber
+    void AbandonTasks() {
+        while (runQueue.Pop()) {
+        }
+        timers.Clear();
+        for (const auto& owned : items) {
+            Item* item = owned.get();
+            if (!item->live) {
+                continue;
+            }
+            if (item->fiber) {
+                DeleteFiber(item->fiber);
+                item->fiber = nullptr;
+            }
+            item->func = nullptr;
+            item->live = false;
+            freeItems.push_back(item);
+        }
+        liveTasks = 0;
+    }
+
+    void RunItem(Item* item) {
+        if (!item->fiber) {
+            if (idleFibers.empty()) {
+                item->fiber = CreateFiber(0, reinterpret_cast<LPFIBER_START_ROUTINE>(&BasicScheduler::FiberMain), this);
+                if (!item->fiber) {
+                    throw std::runtime_error("Failed to create fiber");
+                }
+            } else {
+                item->fiber = idleFibers.back();
+                idleFibers.pop_back();
+            }
+        }
+
+        running = item;
+        SwitchToFiber(item->fiber);
+        running = nullptr;
+
+        if (item->finished) {
+            // Finished fibers sit at the top of their loop and are reused for the next task
+            idleFibers.push_back(item->fiber);
+            item->fiber = nullptr;
+            item->func = nullptr;
+            item->live = false;
+            freeItems.push_back(item);
+            --liveTasks;
+        }
+    }
+
+    static void WINAPI FiberMain(void* arg) {
+        BasicScheduler* self = static_cast<BasicScheduler*>(arg);
+        while (true) {
+            Item* item = self->running;
+            try {
+                item->func();
+            } catch (...) {
+                if (!self->firstError) {
+                    self->firstError = std::current_exception();
+                }
+            }
+            item->finished = true;
+            SwitchToFiber(self->mainFiber);
+        }
+    }
+
+    static inline thread_local BasicScheduler* current = nullptr;
+
+    void* mainFiber = nullptr;
+    bool convertedThread = false;
+    Item* running = nullptr;
+    size_t liveTasks = 0;
+    std::vector<std::unique_ptr<Item>> items;
+    std::vector<Item*> freeItems;
+    std::vector<void*> idleFibers;
+    std::exception_ptr firstError;
+
+    typename RunQueuePolicy::template Queue<Item> runQueue;
+    typename TimerPolicy::template Timers<Item> timers;
+    typename SyncPolicy::Inbox inbox;
+};
+
+// Event loop for a thread that never talks to other threads: no locks, atomics or timer heap
+using SingleThreadScheduler = BasicScheduler<RingRunQueue<4096>, NoTimers, NoSync>;
+
+// Timers and cross-thread Post; the closest policy set to Scheduler's own loop
+using DefaultBasicScheduler = BasicScheduler<DequeRunQueue, HeapTimers, MutexSync>;
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "winAsync.h"
+#include <list>
+
+// Value computed at most once, as a coroutine on the scheduler of the first Get. Every Get, from any
+// thread, returns a task over the same promise, so all callers share one computation and its result.
+template <typename T>
+class AsyncLazy {
+public:
+    explicit AsyncLazy(std::function<T()> compute) : state(std::make_shared<State>()) {
+        state->compute = std::move(compute);
+    }
+
+    // The first call must come from a running coroutine; later calls only hand out the shared task
+    Task<T> Get() {
+        if (!state->started.load(std::memory_order_acquire)) {
+            Scheduler* scheduler = GetCurrentScheduler();
+            if (!scheduler) {
+                throw std::runtime_error("AsyncLazy must be started from within a running coroutine context.");
+            }
+            if (!state->started.exchange(true, std::memory_order_acq_rel)) {
+                scheduler->Launch(state->promise, std::move(state->compute));
+            }
+        }
+        return Task<T>(state->promise);
+    }
+
+    bool IsStarted() const { return state->started.load(std::memory_order_acquire); }
+    bool IsReady() const { return state->promise->IsCompleted(); }
+
+private:
+    struct State {
+        std::shared_ptr<CoroutinePromise<T>> promise = std::make_shared<CoroutinePromise<T>>();
+        std::function<T()> compute;
+        std::atomic<bool> started{false};
+    };
+
+    std::shared_ptr<State> state;
+};
+
+struct SingleFlightOptions {
+    size_t shards = 16;                     // Rounded up to a power of two
+    size_t capacity = 4096;                 // Entries across all shards; each shard evicts its least recently used
+    std::chrono::milliseconds ttl{0};       // Lifetime of a computed value; 0 keeps it until evicted
+};
+
+struct SingleFlightStats {
+    uint64_t hits = 0;              // Served from a computed value
+    uint64_t coalesced = 0;         // Joined a computation that was still in flight
+    uint64_t computations = 0;      // Requests that started a computation
+    uint64_t evictions = 0;
+    uint64_t expirations = 0;
+};
+
+// Keyed single-flight cache. The first request for a key launches compute(key) as a coroutine on the
+// calling scheduler; requests arriving while it runs get a task over the same promise instead of new work.
+// Keys are spread over independently locked shards. Failed computations are dropped, so the next request retries.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class SingleFlightCache {
+public:
+    explicit SingleFlightCache(const SingleFlightOptions& options = SingleFlightOptions()) : ttl(options.ttl) {
+        size_t count = 1;
+        while (count < options.shards) {
+            count <<= 1;
+        }
+        shardMask = count - 1;
+        shardCapacity = std::max<size_t>(1, (options.capacity + count - 1) / count);
+        for (size_t i = 0; i < count; ++i) {
+            shards.push_back(std::make_shared<Shard>());
+        }
+    }
+
+    SingleFlightCache(const SingleFlightCache&) = delete;
+    SingleFlightCache& operator=(const SingleFlightCache&) = delete;
+
+    // Must be called from a running coroutine, which hosts the computation on a miss
+    template <typename Func>
+    Task<Value> GetOrCompute(const Key& key, Func&& compute) {
+        Scheduler* scheduler = GetCurrentScheduler();
+        if (!scheduler) {
+            throw std::runtime_error("GetOrCompute must be called from within a running coroutine context.");
+        }
+
+        const std::shared_ptr<Shard>& shard = shards[ShardIndex(key)];
+        auto promise = std::make_shared<CoroutinePromise<Value>>();
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            auto it = shard->entries.find(key);
+            if (it != shard->entries.end()) {
+                Entry& entry = it->second;
+                if (entry.expires != Clock::time_point::max() && entry.expires <= Clock::now()) {
+                    shard->lru.erase(entry.lruPosition);
+                    shard->entries.erase(it);
+                    ++shard->stats.expirations;
+                } else {
+                    shard->lru.splice(shard->lru.begin(), shard->lru, entry.lruPosition);
+                    ++(entry.promise->IsCompleted() ? shard->stats.hits : shard->stats.coalesced);
+                    return Task<Value>(entry.promise);
+                }
+            }
+
+            shard->lru.push_front(key);
+            shard->entries.emplace(key, Entry{promise, shard->lru.begin()});
+            ++shard->stats.computations;
+            EvictLocked(*shard);
+        }
+
+        // Settles the entry once the computation finishes: start the TTL, or forget a failure
+        std::weak_ptr<Shard> owner = shard;
+        CoroutinePromise<Value>* computed = promise.get();
+        Clock::duration lifetime = ttl;
+        promise->OnCompleted([owner, key, computed, lifetime]() {
+            auto shard = owner.lock();
+            if (!shard) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            auto it = shard->entries.find(key);
+            if (it == shard->entries.end() || it->second.promise.get() != computed) {
+                return;
+            }
+            if (computed->HasException()) {
+                shard->lru.erase(it->second.lruPosition);
+                shard->entries.erase(it);
+            } else if (lifetime.count() > 0) {
+                it->second.expires = Clock::now() + lifetime;
+            }
+        });
+
+        scheduler->Launch(promise, [compute = std::forward<Func>(compute), key]() mutable -> Value {
+            return compute(key);
+        });
+        return Task<Value>(promise);
+    }
+
+    // Requests already holding the key's task still receive its result
+    bool Erase(const Key& key) {
+        Shard& shard = *shards[ShardIndex(key)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return false;
+        }
+        shard.lru.erase(it->second.lruPosition);
+        shard.entries.erase(it);
+        return true;
+    }
+
+    void Clear() {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->entries.clear();
+            shard->lru.clear();
+        }
+    }
+
+    size_t Size() const {
+        size_t total = 0;
+        for (const auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total += shard->entries.size();
+        }
+        return total;
+    }
+
+    SingleFlightStats Stats() const {
+        SingleFlightStats total;
+        for (const auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total.hits += shard->stats.hits;
+            total.coalesced += shard->stats.coalesced;
+            total.computations += shard->stats.computations;
+            total.evictions += shard->stats.evictions;
+            total.expirations += shard->stats.expirations;
+        }
+        return total;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::shared_ptr<CoroutinePromise<Value>> promise;
+        typename std::list<Key>::iterator lruPosition;
+        Clock::time_point expires = Clock::time_point::max();  // Stays max while in flight and without a TTL
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, Entry, Hash> entries;
+        std::list<Key> lru;                 // Most recently used first
+        SingleFlightStats stats;
+    };
+
+    size_t ShardIndex(const Key& key) const {
+        uint64_t mixed = static_cast<uint64_t>(hash(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(mixed >> 32) & shardMask;
+    }
+
+    void EvictLocked(Shard& shard) {
+        // An evicted computation still completes for the callers already holding its task
+        while (shard.entries.size() > shardCapacity) {
+            shard.entries.erase(shard.lru.back());
+            shard.lru.pop_back();
+            ++shard.stats.evictions;
+        }
+    }
+
+    std::vector<std::shared_ptr<Shard>> shards;
+    Hash hash;
+    size_t shardMask = 0;
+    size_t shardCapacity = 1;
+    Clock::duration ttl;
+};
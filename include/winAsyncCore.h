@@ -0,0 +1,76 @@
+#pragma once
+
+#include "winAsync.h"
+
+// Bounded lock-free ring with exactly one producer thread and one consumer thread
+class SpscMailbox {
+public:
+    SpscMailbox(size_t capacity, DWORD numaNode);
+    ~SpscMailbox();
+
+    SpscMailbox(const SpscMailbox&) = delete;
+    SpscMailbox& operator=(const SpscMailbox&) = delete;
+
+    bool TryPush(std::function<void()>& job);
+    bool TryPop(std::function<void()>& job);
+    bool Empty() const;
+
+private:
+    std::function<void()>* slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+// Runs one pinned Scheduler per core. Cores share nothing; work crosses cores only via mailboxes
+class CoreRuntime {
+public:
+    static constexpr size_t kNoCore = static_cast<size_t>(-1);
+
+    explicit CoreRuntime(size_t numCores = 0, size_t mailboxCapacity = 256);
+    ~CoreRuntime();
+
+    CoreRuntime(const CoreRuntime&) = delete;
+    CoreRuntime& operator=(const CoreRuntime&) = delete;
+
+    size_t CoreCount() const;
+
+    // Runs every job already posted, then joins the cores. Later SubmitTo calls throw
+    void Stop();
+
+    // Index of the calling thread within this runtime, or kNoCore for outside threads
+    size_t CurrentCore() const;
+
+    template <typename T, typename Func, typename... Args>
+    Task<T> SubmitTo(size_t core, Func&& func, Args&&... args);
+
+private:
+    struct Core;
+
+    void Post(size_t core, std::function<void()> job);
+    void CoreLoop(Core* core);
+    void PumpMailboxes(Core* core);
+    static void CloseMailboxes(Core* core);
+    static bool DrainMailboxes(Core* core);
+    static bool HasPendingJobs(const Core* core);
+    static void PinCurrentThread(size_t index);
+
+    std::vector<std::unique_ptr<Core>> cores;
+    size_t mailboxCapacity;
+    bool stopped = false;
+};
+
+template <typename T, typename Func, typename... Args>
+Task<T> CoreRuntime::SubmitTo(size_t core, Func&& func, Args&&... args) {
+    if (core >= cores.size()) {
+        throw std::out_of_range("SubmitTo: core index out of range");
+    }
+
+    auto promise = std::make_shared<CoroutinePromise<T>>();
+    auto task = std::bind(std::forward<Func>(func), std::forward<Args>(args)...);
+
+    Post(core, [promise, task]() mutable {
+        GetCurrentScheduler()->Launch(promise, std::move(task));
+    });
+    return Task<T>(promise);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "winAsync.h"
+
+// Coroutine synchronization primitives usable across schedulers, pool workers and plain threads.
+// A waiting coroutine parks with SuspendExecution and is woken through its scheduler's completion
+// port, so the event loop keeps running other coroutines. A plain thread sleeps in WaitOnAddress until it is released.
+// Setting an event nobody waits on, and waiting on one that is already set, take no lock.
+
+// One blocked waiter; lives on the waiter's stack until it is released
+struct AsyncWaiter : public IoOperation {
+    AsyncWaiter();
+
+    // Returns once Release has been called, parking the coroutine or blocking the thread on released
+    void Park();
+
+    // Wakes the waiter from any thread. The waiter may be gone once this returns
+    void Release();
+
+    Scheduler* scheduler;           // Null for a plain thread
+    AsyncWaiter* next = nullptr;
+    std::atomic<bool> released{false};
+};
+
+// Intrusive FIFO of waiters; callers provide the locking
+class AsyncWaiterQueue {
+public:
+    void Push(AsyncWaiter* waiter);
+    AsyncWaiter* Pop();
+    AsyncWaiter* TakeAll();
+    bool Empty() const { return head == nullptr; }
+
+private:
+    AsyncWaiter* head = nullptr;
+    AsyncWaiter* tail = nullptr;
+};
+
+// Stays set until Reset; Set releases every waiter
+class AsyncManualResetEvent {
+public:
+    explicit AsyncManualResetEvent(bool initiallySet = false);
+
+    AsyncManualResetEvent(const AsyncManualResetEvent&) = delete;
+    AsyncManualResetEvent& operator=(const AsyncManualResetEvent&) = delete;
+
+    void Set();
+    void Reset();
+    bool IsSet() const;
+    void Wait();
+
+private:
+    // this = set; nullptr = not set and nobody waiting; otherwise the most recent waiter
+    std::atomic<void*> state;
+};
+
+// Each Set releases exactly one waiter; with nobody waiting the next Wait passes and resets it
+class AsyncAutoResetEvent {
+public:
+    explicit AsyncAutoResetEvent(bool initiallySet = false);
+
+    AsyncAutoResetEvent(const AsyncAutoResetEvent&) = delete;
+    AsyncAutoResetEvent& operator=(const AsyncAutoResetEvent&) = delete;
+
+    void Set();
+    bool TryWait();
+    void Wait();
+
+private:
+    // 1 = set, 0 = idle, -n = n waiters queued
+    std::atomic<int64_t> state;
+    std::mutex mutex;
+    AsyncWaiterQueue waiters;
+};
+
+// Single-use countdown; Wait returns once the count reaches zero
+class AsyncLatch {
+public:
+    explicit AsyncLatch(ptrdiff_t count);
+
+    AsyncLatch(const AsyncLatch&) = delete;
+    AsyncLatch& operator=(const AsyncLatch&) = delete;
+
+    void CountDown(ptrdiff_t n = 1);
+    bool IsReady() const { return ready.IsSet(); }
+    void Wait() { ready.Wait(); }
+    void ArriveAndWait(ptrdiff_t n = 1);
+
+private:
+    std::atomic<ptrdiff_t> remaining;
+    AsyncManualResetEvent ready;
+};
+
+// Reusable barrier; onPhaseComplete runs on the last arriver before the others are released
+class AsyncBarrier {
+public:
+    explicit AsyncBarrier(size_t participants, std::function<void()> onPhaseComplete = nullptr);
+
+    AsyncBarrier(const AsyncBarrier&) = delete;
+    AsyncBarrier& operator=(const AsyncBarrier&) = delete;
+
+    void ArriveAndWait();
+
+    // Leaves the barrier for good; later phases wait for one fewer participant
+    void ArriveAndDrop();
+
+private:
+    void CompletePhaseLocked(std::unique_lock<std::mutex>& lock);
+
+    std::mutex mutex;
+    size_t participants;
+    size_t remaining;
+    std::function<void()> onPhaseComplete;
+    AsyncWaiterQueue waiters;
+};
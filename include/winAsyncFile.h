@@ -0,0 +1,54 @@
+#pragma once
+
+#include "winAsync.h"
+#include <string>
+
+struct FileReaderOptions {
+    size_t chunkSize = 1 << 20;     // Bytes per read; rounded up to 4 KiB when unbuffered
+    size_t readahead = 4;           // Reads kept in flight
+    size_t maxBufferedChunks = 8;   // Chunks read but not yet consumed before reads pause
+    bool unbuffered = false;        // FILE_FLAG_NO_BUFFERING: bypass the cache, buffers are page aligned
+};
+
+// Sequential reader that keeps several overlapped reads in flight on the current scheduler's
+// IOCP and hands chunks to the consuming coroutine in file order
+class AsyncFileReader {
+public:
+    struct Chunk {
+        const char* data = nullptr;
+        size_t size = 0;
+        uint64_t offset = 0;
+    };
+
+    explicit AsyncFileReader(const std::wstring& path, const FileReaderOptions& options = FileReaderOptions());
+    ~AsyncFileReader();
+
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    // Suspends until the next chunk is ready; false at end of file.
+    // The chunk stays valid until the following call, which recycles its buffer
+    bool Next(Chunk& chunk);
+    uint64_t Size() const;
+
+private:
+    enum class SlotState { Free, Reading, Held };
+
+    struct Slot {
+        IoOperation op;
+        char* buffer = nullptr;
+        uint64_t offset = 0;
+        SlotState state = SlotState::Free;
+    };
+
+    void Refill();
+    void IssueRead(Slot& slot);
+
+    HANDLE file = INVALID_HANDLE_VALUE;
+    FileReaderOptions options;
+    uint64_t fileSize = 0;
+    uint64_t nextOffset = 0;
+    std::vector<Slot> slots;
+    size_t issueIndex = 0;
+    size_t consumeIndex = 0;
+};
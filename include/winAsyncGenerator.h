@@ -0,0 +1,334 @@
+#pragma once
+
+#include "winAsync.h"
+#include <iterator>
+#include <utility>
+
+// Generators on a plain thread share one thread-to-fiber conversion, undone when the last of them goes away
+class GeneratorFiberThread {
+public:
+    // Returns true if the caller now holds a reference it must Release
+    static bool Acquire() {
+        GeneratorFiberThread& self = Current();
+        if (self.users == 0) {
+            if (IsThreadAFiber()) {
+                return false;
+            }
+            ConvertThreadToFiber(nullptr);
+        }
+        ++self.users;
+        return true;
+    }
+
+    static void Release() {
+        GeneratorFiberThread& self = Current();
+        if (--self.users == 0) {
+            ConvertFiberToThread();
+        }
+    }
+
+private:
+    static GeneratorFiberThread& Current() {
+        static thread_local GeneratorFiberThread current;
+        return current;
+    }
+
+    size_t users = 0;
+};
+
+// Synchronous pull generator. The producer runs on its own fiber and hands each value to the
+// consumer through a single pointer slot, so no item is copied into a queue or allocated.
+// The producer must not call YieldExecution/AsyncSleep/SuspendExecution; use AsyncStream for that.
+//
+// A producer that throws ends the sequence: the exception is rethrown from the Next call that resumed it.
+//
+// Cancellation: when the generator is destroyed mid-stream, the producer is resumed once and its
+// pending Yield returns false, so it can return and unwind normally. A producer that ignores that
+// and yields again is never resumed: its fiber is deleted and objects on its stack are not destroyed.
+template <typename T>
+class Generator {
+    struct State;
+
+public:
+    class Yielder {
+    public:
+        // Returns false once the consumer has stopped iterating; the producer must then return
+        bool Yield(T& value) { return owner->YieldValue(value); }
+        bool Yield(T&& value) { return owner->YieldValue(value); }
+
+    private:
+        friend class Generator;
+        State* owner = nullptr;
+    };
+
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        Iterator() = default;
+        explicit Iterator(Generator* g) : generator(g) { Advance(); }
+
+        T& operator*() const { return generator->Current(); }
+        T* operator->() const { return &generator->Current(); }
+        Iterator& operator++() { Advance(); return *this; }
+        bool operator==(const Iterator& other) const { return generator == other.generator; }
+        bool operator!=(const Iterator& other) const { return generator != other.generator; }
+
+    private:
+        void Advance() {
+            if (generator && !generator->Next()) {
+                generator = nullptr;
+            }
+        }
+
+        Generator* generator = nullptr;
+    };
+
+    explicit Generator(std::function<void(Yielder&)> producer) : state(std::make_unique<State>()) {
+        state->producer = std::move(producer);
+        state->yielder.owner = state.get();
+    }
+
+    Generator(Generator&&) noexcept = default;
+    Generator& operator=(Generator&&) noexcept = default;
+
+    ~Generator() {
+        if (!state) {
+            return;
+        }
+        if (state->producerFiber && !state->finished) {
+            // Let the producer observe the cancellation and unwind its own stack
+            state->cancelled = true;
+            SwitchToProducer();
+        }
+        if (state->producerFiber) {
+            DeleteFiber(state->producerFiber);
+        }
+        if (state->convertedThread) {
+            GeneratorFiberThread::Release();
+        }
+    }
+
+    bool Next() {
+        if (state->finished) {
+            return false;
+        }
+        if (!state->producerFiber) {
+            state->convertedThread = GeneratorFiberThread::Acquire();
+            state->producerFiber = CreateFiber(0, reinterpret_cast<LPFIBER_START_ROUTINE>(&Generator::FiberEntry), state.get());
+            if (!state->producerFiber) {
+                throw std::runtime_error("Failed to create generator fiber");
+            }
+        }
+
+        state->slot = nullptr;
+        SwitchToProducer();
+        if (state->error) {
+            std::rethrow_exception(std::exchange(state->error, nullptr));
+        }
+        return !state->finished;
+    }
+
+    T& Current() const { return *state->slot; }
+
+    Iterator begin() { return Iterator(this); }
+    Iterator end() { return Iterator(); }
+
+private:
+    struct State {
+        bool YieldValue(T& value) {
+            if (cancelled) {
+                // The producer kept going after being told to stop: park for good, the generator deletes this fiber
+                SwitchToFiber(consumerFiber);
+                return false;
+            }
+            slot = &value;
+            SwitchToFiber(consumerFiber);
+            return !cancelled;
+        }
+
+        std::function<void(Yielder&)> producer;
+        Yielder yielder;
+        void* producerFiber = nullptr;
+        void* consumerFiber = nullptr;
+        T* slot = nullptr;
+        std::exception_ptr error;
+        bool finished = false;
+        bool cancelled = false;
+        bool convertedThread = false;
+    };
+
+    // Inside a coroutine, the producer runs with none marked running so the VEH leaves its exceptions
+    // to the catch in FiberEntry instead of charging them to the consumer
+    void SwitchToProducer() {
+        Scheduler* scheduler = GetCurrentScheduler();
+        Coroutine* running = scheduler ? std::exchange(scheduler->runningCoroutine, nullptr) : nullptr;
+        state->consumerFiber = GetCurrentFiber();
+        SwitchToFiber(state->producerFiber);
+        if (scheduler) {
+            scheduler->runningCoroutine = running;
+        }
+    }
+
+    static void WINAPI FiberEntry(void* arg) {
+        State* s = static_cast<State*>(arg);
+        if (!s->cancelled) {
+            try {
+                s->producer(s->yielder);
+            } catch (...) {
+                s->error = std::current_exception();
+            }
+        }
+        s->finished = true;
+        s->slot = nullptr;
+        // A fiber routine must never return; park here until the generator deletes this fiber
+        while (true) {
+            SwitchToFiber(s->consumerFiber);
+        }
+    }
+
+    std::unique_ptr<State> state;
+};
+
+// Pull stream whose producer is a coroutine on the current scheduler, so it may perform
+// I/O or sleep between yields. Values pass through the same single-slot handoff as Generator;
+// each side parks while it waits and the other side makes it runnable directly.
+template <typename T>
+class AsyncStream {
+    struct State;
+
+public:
+    class Yielder {
+    public:
+        // Parks the producer until the consumer asks for the next item; false once the consumer has gone
+        bool Yield(T& value) { return owner->YieldValue(value); }
+        bool Yield(T&& value) { return owner->YieldValue(value); }
+
+    private:
+        friend class AsyncStream;
+        State* owner = nullptr;
+    };
+
+    explicit AsyncStream(std::function<void(Yielder&)> producer) : state(std::make_shared<State>()) {
+        state->producer = std::move(producer);
+        state->yielder.owner = state.get();
+    }
+
+    AsyncStream(AsyncStream&&) noexcept = default;
+    AsyncStream& operator=(AsyncStream&&) noexcept = default;
+
+    ~AsyncStream() {
+        if (state) {
+            state->cancelled = true;
+            state->hasValue = false;
+            state->WakeProducer();
+        }
+    }
+
+    // Must be called from a coroutine on the scheduler that will run the producer
+    bool Next() {
+        if (!state->producerDone) {
+            Scheduler* scheduler = GetCurrentScheduler();
+            if (!scheduler || !scheduler->GetRunningCoroutine()) {
+                throw std::runtime_error("AsyncStream must be consumed from within a running coroutine.");
+            }
+            auto shared = state;
+            state->scheduler = scheduler;
+            state->producerDone = scheduler->CreateCoroutine<void>([shared]() {
+                shared->producer(shared->yielder);
+            });
+            // Also covers a producer that threw: its promise completes from the scheduler's cleanup pass
+            state->producerDone->OnCompleted([shared]() { shared->WakeConsumer(); });
+        }
+
+        // Releasing the previous item lets the producer continue
+        state->hasValue = false;
+        state->WakeProducer();
+        while (!state->hasValue && !state->producerDone->IsCompleted()) {
+            state->waitingConsumer = state->scheduler->GetRunningCoroutine();
+            Coroutine::SuspendExecution();
+        }
+        if (!state->hasValue) {
+            state->producerDone->RethrowIfException();
+            return false;
+        }
+        return true;
+    }
+
+    T& Current() const { return *state->slot; }
+
+    class StreamIterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        StreamIterator() = default;
+        explicit StreamIterator(AsyncStream* s) : stream(s) { Advance(); }
+
+        T& operator*() const { return stream->Current(); }
+        T* operator->() const { return &stream->Current(); }
+        StreamIterator& operator++() { Advance(); return *this; }
+        bool operator==(const StreamIterator& other) const { return stream == other.stream; }
+        bool operator!=(const StreamIterator& other) const { return stream != other.stream; }
+
+    private:
+        void Advance() {
+            if (stream && !stream->Next()) {
+                stream = nullptr;
+            }
+        }
+
+        AsyncStream* stream = nullptr;
+    };
+
+    StreamIterator begin() { return StreamIterator(this); }
+    StreamIterator end() { return StreamIterator(); }
+
+private:
+    struct State {
+        bool YieldValue(T& value) {
+            if (cancelled) {
+                return false;
+            }
+            slot = &value;
+            hasValue = true;
+            WakeConsumer();
+            while (hasValue && !cancelled) {
+                waitingProducer = scheduler->GetRunningCoroutine();
+                Coroutine::SuspendExecution();
+            }
+            return !cancelled;
+        }
+
+        void WakeConsumer() {
+            if (Coroutine* co = std::exchange(waitingConsumer, nullptr)) {
+                scheduler->MakeRunnable(co);
+            }
+        }
+
+        void WakeProducer() {
+            if (Coroutine* co = std::exchange(waitingProducer, nullptr)) {
+                scheduler->MakeRunnable(co);
+            }
+        }
+
+        std::function<void(Yielder&)> producer;
+        Yielder yielder;
+        Scheduler* scheduler = nullptr;
+        Coroutine* waitingConsumer = nullptr;
+        Coroutine* waitingProducer = nullptr;
+        std::shared_ptr<CoroutinePromise<void>> producerDone;
+        T* slot = nullptr;
+        bool hasValue = false;
+        bool cancelled = false;
+    };
+
+    std::shared_ptr<State> state;
+};
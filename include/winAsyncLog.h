@@ -0,0 +1,139 @@
+#pragma once
+
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Asynchronous logging. A log call encodes its arguments into a small binary record and copies it
+// into a lock-free ring owned by the calling thread; a background thread formats and writes it.
+// The logger thread and a thread's ring are created by that thread's first log call, so a process
+// that never logs pays nothing. After that a call never allocates, blocks or takes a lock, so it is
+// usable from fibers and pool workers; the logger sleeps until a producer finds it idle and wakes it.
+// Inside the VEH a thread without a ring drops its records instead of creating one. Records that do
+// not fit in a full ring are dropped and counted as well.
+
+enum class LogLevel : uint8_t { Trace, Debug, Info, Warn, Error };
+
+// Records below this level compile away entirely, including the evaluation of their arguments
+#ifndef WINASYNC_LOG_LEVEL
+#ifdef DEBUG_COROUTINE
+#define WINASYNC_LOG_LEVEL 0
+#else
+#define WINASYNC_LOG_LEVEL 2
+#endif
+#endif
+
+#define WINASYNC_LOG_AT(level, ...) \
+    do { \
+        if constexpr (static_cast<int>(level) >= WINASYNC_LOG_LEVEL) { \
+            LogWrite(level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_TRACE(...) WINASYNC_LOG_AT(LogLevel::Trace, __VA_ARGS__)
+#define LOG_DEBUG(...) WINASYNC_LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) WINASYNC_LOG_AT(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...) WINASYNC_LOG_AT(LogLevel::Warn, __VA_ARGS__)
+#define LOG_ERROR(...) WINASYNC_LOG_AT(LogLevel::Error, __VA_ARGS__)
+
+// Type-tagged argument payload of one record; strings are copied because they may not outlive the call
+class LogRecordBuilder {
+public:
+    static constexpr size_t kMaxArgBytes = 480;
+    static constexpr size_t kMaxStringBytes = 255;   // Longer string arguments are truncated; the length is stored in one byte
+
+    enum ArgType : uint8_t { Signed, Unsigned, Double, Pointer, String };
+
+    template <typename T>
+    void Append(const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            Put(Unsigned, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_enum_v<T>) {
+            Append(static_cast<std::underlying_type_t<T>>(value));
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            Put(Signed, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral_v<T>) {
+            Put(Unsigned, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            Put(Double, static_cast<double>(value));
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            PutString(value.data(), value.size());
+        } else if constexpr (std::is_array_v<T> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<T>>, char>) {
+            PutString(value, strnlen(value, sizeof(T)));
+        } else if constexpr (std::is_pointer_v<T> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>) {
+            const char* text = value ? value : "(null)";
+            PutString(text, strlen(text));
+        } else if constexpr (std::is_pointer_v<T> || std::is_null_pointer_v<T>) {
+            Put(Pointer, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(static_cast<const void*>(value))));
+        } else {
+            static_assert(std::is_pointer_v<T>, "Unsupported log argument type");
+        }
+    }
+
+    const char* Data() const { return data; }
+    size_t Size() const { return size; }
+    uint8_t Count() const { return count; }
+
+private:
+    template <typename Value>
+    void Put(ArgType type, Value value) {
+        if (size + 1 + sizeof(Value) > kMaxArgBytes) {
+            return;
+        }
+        data[size++] = static_cast<char>(type);
+        std::memcpy(data + size, &value, sizeof(Value));
+        size += sizeof(Value);
+        ++count;
+    }
+
+    void PutString(const char* text, size_t length) {
+        if (size + 2 > kMaxArgBytes) {
+            return;
+        }
+        length = std::min(std::min(length, kMaxStringBytes), kMaxArgBytes - size - 2);
+        data[size++] = static_cast<char>(String);
+        data[size++] = static_cast<char>(length);
+        std::memcpy(data + size, text, length);
+        size += length;
+        ++count;
+    }
+
+    char data[kMaxArgBytes];
+    size_t size = 0;
+    uint8_t count = 0;
+};
+
+void LogSubmit(LogLevel level, const char* format, const LogRecordBuilder& args);
+
+// Bracket the VEH; leave before switching fibers, since the faulting fiber is never resumed
+void LogEnterExceptionHandler();
+void LogLeaveExceptionHandler();
+
+// The format string must be a literal (or otherwise outlive the logger): only its address is recorded
+template <typename... Args>
+void LogWrite(LogLevel level, const char* format, const Args&... args) {
+    LogRecordBuilder builder;
+    (builder.Append(args), ...);
+    LogSubmit(level, format, builder);
+}
+
+class AsyncLogger {
+public:
+    // Creates the calling thread's ring ahead of its first record, e.g. for a thread that may first log
+    // from the VEH. Idempotent
+    static void RegisterThread();
+
+    // Output stream used by the background thread; stdout by default
+    static void SetSink(FILE* sink);
+
+    // Blocks until every record logged before the call has been written to the sink
+    static void Flush();
+
+    // Records lost because a thread's ring was full, or because it had none inside the VEH
+    static uint64_t DroppedRecords();
+};
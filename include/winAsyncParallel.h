@@ -0,0 +1,208 @@
+#pragma once
+
+#include "winAsync.h"
+#include <algorithm>
+#include <iterator>
+
+// Range algorithms on the thread pool. Ranges are split lazily: a worker only hands
+// half of its remaining range back to the pool when the pool queue has run dry, so
+// the number of pool submissions adapts to how many workers are actually hungry.
+
+inline size_t DefaultParallelGrain(size_t count) {
+    size_t workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+    return std::max<size_t>(1, count / (workers * 32));
+}
+
+inline bool ParallelPoolIsHungry() {
+    return Scheduler::GetThreadPool().PendingTasks() == 0;
+}
+
+// Joins the pool chunks of one parallel call. Each chunk reports through its pool onDone, since a
+// throwing chunk's fiber is abandoned by the VEH and never reaches code after the throw. The first
+// failure is kept and cancels the rest at their next split point; the call completes only once every
+// chunk has returned, so captures need to outlive the Await and no longer.
+class ParallelJoin {
+public:
+    explicit ParallelJoin(std::function<void(std::shared_ptr<ExceptionState>)> done) : onComplete(std::move(done)) {}
+
+    bool IsCancelled() const { return cancelled.load(std::memory_order_acquire); }
+
+protected:
+    template <typename State, typename Func>
+    static void Fork(const std::shared_ptr<State>& state, Func&& chunk) {
+        state->outstanding.fetch_add(1, std::memory_order_relaxed);
+        Scheduler::GetThreadPool().Submit(std::forward<Func>(chunk), nullptr, [state](std::shared_ptr<ExceptionState> exState) {
+            state->ChunkDone(exState);
+        });
+    }
+
+private:
+    void ChunkDone(const std::shared_ptr<ExceptionState>& exState) {
+        if (exState && HasException(exState.get()) && !cancelled.exchange(true, std::memory_order_acq_rel)) {
+            firstError = exState;
+        }
+        // The last chunk's acq_rel decrement orders every earlier write to firstError before this read
+        if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            onComplete(std::move(firstError));
+        }
+    }
+
+    std::function<void(std::shared_ptr<ExceptionState>)> onComplete;
+    std::shared_ptr<ExceptionState> firstError;
+    std::atomic<size_t> outstanding{0};
+    std::atomic<bool> cancelled{false};
+};
+
+template <typename U>
+void CompletePromiseFromJoin(const std::shared_ptr<CoroutinePromise<U>>& promise, std::shared_ptr<ExceptionState> exState) {
+    if (exState) {
+        promise->SetException(std::move(exState));
+    } else {
+        promise->SetResult();
+    }
+}
+
+template <typename Index, typename RangeBody>
+class ParallelRangeState : public ParallelJoin, public std::enable_shared_from_this<ParallelRangeState<Index, RangeBody>> {
+public:
+    ParallelRangeState(RangeBody b, size_t g, std::function<void(std::shared_ptr<ExceptionState>)> done) : ParallelJoin(std::move(done)), body(std::move(b)), grain(g) {}
+
+    void Submit(Index begin, Index end) {
+        auto self = this->shared_from_this();
+        Fork(self, [self, begin, end]() { self->RunRange(begin, end); });
+    }
+
+private:
+    void RunRange(Index begin, Index end) {
+        while (static_cast<size_t>(end - begin) > grain) {
+            if (IsCancelled()) {
+                return;
+            }
+            if (ParallelPoolIsHungry()) {
+                Index mid = begin + (end - begin) / 2;
+                Submit(mid, end);
+                end = mid;
+                continue;
+            }
+            Index stop = begin + static_cast<Index>(grain);
+            body(begin, stop);
+            begin = stop;
+        }
+        if (begin < end) {
+            body(begin, end);
+        }
+    }
+
+    RangeBody body;
+    size_t grain;
+};
+
+template <typename Index, typename RangeBody>
+void LaunchParallelRange(Index first, Index last, RangeBody body, size_t grain, std::function<void(std::shared_ptr<ExceptionState>)> onComplete) {
+    if (last <= first) {
+        onComplete(nullptr);
+        return;
+    }
+
+    size_t count = static_cast<size_t>(last - first);
+    auto state = std::make_shared<ParallelRangeState<Index, RangeBody>>(std::move(body), grain ? grain : DefaultParallelGrain(count), std::move(onComplete));
+    state->Submit(first, last);
+}
+
+template <typename Index, typename Body>
+Task<void> ParallelFor(Index first, Index last, Body body, size_t grain = 0) {
+    static_assert(std::is_integral_v<Index>, "ParallelFor iterates over an integral index range");
+
+    auto promise = std::make_shared<CoroutinePromise<void>>();
+    LaunchParallelRange(first, last, [body = std::move(body)](Index begin, Index end) mutable {
+        for (Index i = begin; i < end; ++i) {
+            body(i);
+        }
+    }, grain, [promise](std::shared_ptr<ExceptionState> exState) { CompletePromiseFromJoin(promise, std::move(exState)); });
+    return Task<void>(promise);
+}
+
+// Combine must be associative and commutative: partial results are merged in completion order
+template <typename Index, typename T, typename Map, typename Combine>
+Task<T> ParallelReduce(Index first, Index last, T identity, Map map, Combine combine, size_t grain = 0) {
+    static_assert(std::is_integral_v<Index>, "ParallelReduce iterates over an integral index range");
+
+    struct ReduceState {
+        explicit ReduceState(T initial) : total(std::move(initial)) {}
+        std::mutex mutex;
+        T total;
+    };
+
+    auto reduceState = std::make_shared<ReduceState>(identity);
+    auto promise = std::make_shared<CoroutinePromise<T>>();
+
+    // Each chunk folds into a local accumulator and merges once, so the lock is taken per chunk, not per element
+    LaunchParallelRange(first, last, [reduceState, identity, map, combine](Index begin, Index end) mutable {
+        T local = identity;
+        for (Index i = begin; i < end; ++i) {
+            local = combine(std::move(local), map(i));
+        }
+        std::lock_guard<std::mutex> lock(reduceState->mutex);
+        reduceState->total = combine(std::move(reduceState->total), std::move(local));
+    }, grain, [reduceState, promise](std::shared_ptr<ExceptionState> exState) {
+        if (exState) {
+            promise->SetException(std::move(exState));
+        } else {
+            promise->SetResult(std::move(reduceState->total));
+        }
+    });
+    return Task<T>(promise);
+}
+
+template <typename RandomIt, typename Compare>
+class ParallelSortState : public ParallelJoin, public std::enable_shared_from_this<ParallelSortState<RandomIt, Compare>> {
+public:
+    ParallelSortState(Compare c, size_t g, std::function<void(std::shared_ptr<ExceptionState>)> done) : ParallelJoin(std::move(done)), comp(std::move(c)), grain(g) {}
+
+    void Submit(RandomIt first, RandomIt last) {
+        auto self = this->shared_from_this();
+        Fork(self, [self, first, last]() { self->SortRange(first, last); });
+    }
+
+private:
+    void SortRange(RandomIt first, RandomIt last) {
+        // Quicksort that only forks the upper partition while some pool worker is idle
+        while (static_cast<size_t>(last - first) > grain && ParallelPoolIsHungry()) {
+            if (IsCancelled()) {
+                return;
+            }
+            auto pivot = MedianOfThree(first, first + (last - first) / 2, last - 1);
+            RandomIt lowerEnd = std::partition(first, last, [&](const auto& value) { return comp(value, pivot); });
+            RandomIt upperBegin = std::partition(lowerEnd, last, [&](const auto& value) { return !comp(pivot, value); });
+
+            Submit(upperBegin, last);
+            last = lowerEnd;
+        }
+        std::sort(first, last, comp);
+    }
+
+    typename std::iterator_traits<RandomIt>::value_type MedianOfThree(RandomIt a, RandomIt b, RandomIt c) {
+        if (comp(*b, *a)) std::swap(a, b);
+        if (comp(*c, *b)) std::swap(b, c);
+        if (comp(*b, *a)) std::swap(a, b);
+        return *b;
+    }
+
+    Compare comp;
+    size_t grain;
+};
+
+template <typename RandomIt, typename Compare = std::less<>>
+Task<void> ParallelSort(RandomIt first, RandomIt last, Compare comp = Compare(), size_t grain = 0) {
+    auto promise = std::make_shared<CoroutinePromise<void>>();
+    size_t count = static_cast<size_t>(last - first);
+    if (count < 2) {
+        promise->SetResult();
+        return Task<void>(promise);
+    }
+
+    auto state = std::make_shared<ParallelSortState<RandomIt, Compare>>(std::move(comp), grain ? grain : std::max<size_t>(DefaultParallelGrain(count), 4096),
+        [promise](std::shared_ptr<ExceptionState> exState) { CompletePromiseFromJoin(promise, std::move(exState)); });
+    state->Submit(first, last);
+    return Task<void>(promise);
+}
@@ -4,14 +4,26 @@
 
 class CoroutinePromiseBase {
 public:
-    CoroutinePromiseBase() : completed(false) {}
+    CoroutinePromiseBase() : completed(false), continuations(nullptr) {}
+
+    ~CoroutinePromiseBase() {
+        ContinuationNode* node = continuations.load(std::memory_order_acquire);
+        while (node && node != CompletedSentinel()) {
+            ContinuationNode* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    CoroutinePromiseBase(const CoroutinePromiseBase&) = delete;
+    CoroutinePromiseBase& operator=(const CoroutinePromiseBase&) = delete;
 
     void SetException(std::shared_ptr<ExceptionState> exState) {
         exception = exState;
-        completed = true;
+        MarkCompleted();
     }
 
-    bool IsCompleted() const { return completed; }
+    bool IsCompleted() const { return completed.load(std::memory_order_acquire); }
 
     bool HasException() const {
         return exception && ::HasException(exception.get());
@@ -23,8 +35,54 @@ public:
         }
     }
 
+    std::shared_ptr<ExceptionState> GetExceptionState() const { return exception; }
+
+    // Runs func on whichever thread completes the promise, or right away if it already has
+    void OnCompleted(std::function<void()> func) {
+        auto* node = new ContinuationNode{std::move(func), continuations.load(std::memory_order_acquire)};
+        while (node->next != CompletedSentinel()) {
+            if (continuations.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_acquire)) {
+                return;
+            }
+        }
+        std::function<void()> ready = std::move(node->func);
+        delete node;
+        ready();
+    }
+
 protected:
-    bool completed;
+    struct ContinuationNode {
+        std::function<void()> func;
+        ContinuationNode* next;
+    };
+
+    static ContinuationNode* CompletedSentinel() {
+        static ContinuationNode sentinel{nullptr, nullptr};
+        return &sentinel;
+    }
+
+    void MarkCompleted() {
+        completed.store(true, std::memory_order_release);
+
+        // Continuations were pushed as a stack; run them in registration order
+        ContinuationNode* node = continuations.exchange(CompletedSentinel(), std::memory_order_acq_rel);
+        ContinuationNode* ordered = nullptr;
+        while (node) {
+            ContinuationNode* next = node->next;
+            node->next = ordered;
+            ordered = node;
+            node = next;
+        }
+        while (ordered) {
+            ContinuationNode* next = ordered->next;
+            ordered->func();
+            delete ordered;
+            ordered = next;
+        }
+    }
+
+    std::atomic<bool> completed;
+    std::atomic<ContinuationNode*> continuations;
     std::shared_ptr<ExceptionState> exception;
 };
 
@@ -33,7 +91,7 @@ class CoroutinePromise : public CoroutinePromiseBase {
 public:
     void SetResult(T value) {
         result = std::move(value);
-        completed = true;
+        MarkCompleted();
     }
 
     T GetResult() {
@@ -48,21 +106,59 @@ private:
 template <>
 class CoroutinePromise<void> : public CoroutinePromiseBase {
 public:
-    void SetResult() { completed = true; }
+    void SetResult() { MarkCompleted(); }
 
     void GetResult() { RethrowIfException(); }
 };
 
+template <typename T>
+struct IsTask : std::false_type {};
+
+template <typename T>
+struct IsTask<Task<T>> : std::true_type {};
+
+template <typename T, typename Func>
+struct ContinuationResult {
+    using type = std::invoke_result_t<Func, T>;
+};
+
+template <typename Func>
+struct ContinuationResult<void, Func> {
+    using type = std::invoke_result_t<Func>;
+};
+
 template <typename T>
 class Task {
 public:
     explicit Task(std::shared_ptr<CoroutinePromise<T>> p) : promise(std::move(p)) {}
     std::shared_ptr<CoroutinePromise<T>> GetPromise() const { return promise; }
+
+    // Runs func(result) inline on whichever thread completes this task, without spawning a coroutine.
+    // func must not yield or Await; exceptions skip func and flow to the returned task, as does an
+    // exception thrown by func
+    template <typename Func>
+    Task<typename ContinuationResult<T, Func>::type> Then(Func&& func) const;
+
+    // Runs func(result) as a coroutine on the given event-loop scheduler. If that scheduler is destroyed
+    // before running it, the returned task fails instead of never completing
+    template <typename Func>
+    Task<typename ContinuationResult<T, Func>::type> Then(Scheduler& scheduler, Func&& func) const;
+
+    // Runs func(task) like Then once the task completes, whether or not it failed
+    template <typename Func>
+    Task<std::invoke_result_t<Func, Task<T>>> ContinueWith(Func&& func) const;
+
+    // Task<Task<U>> -> Task<U>
+    auto Unwrap() const;
+
 private:
+    template <typename U, typename Step>
+    static void RunContinuation(const std::shared_ptr<CoroutinePromise<U>>& next, Step step);
+
     std::shared_ptr<CoroutinePromise<T>> promise;
 };
 
-template <typename T, typename Func, typename... Args>
+template <typename T, typename Func, typename = EnableIfNotTaskTag<Func>, typename... Args>
 Task<T> CreateTask(Func&& func, Args&&... args) {
     Scheduler* scheduler = GetCurrentScheduler();
     if (!scheduler) {
@@ -72,6 +168,16 @@ Task<T> CreateTask(Func&& func, Args&&... args) {
     return Task<T>(promise);
 }
 
+template <typename T, typename Func, typename... Args>
+Task<T> CreateTask(const TaskTag& tag, Func&& func, Args&&... args) {
+    Scheduler* scheduler = GetCurrentScheduler();
+    if (!scheduler) {
+        throw std::runtime_error("CreateTask must be called from within a running coroutine context.");
+    }
+    auto promise = scheduler->CreateCoroutine<T>(tag, std::forward<Func>(func), std::forward<Args>(args)...);
+    return Task<T>(promise);
+}
+
 template <typename T>
 T Await(Task<T>& task) {
     auto promise = task.GetPromise();
@@ -89,10 +195,9 @@ inline void Await(Task<void>& task) {
     promise->GetResult();
 }
 
-template <typename T, typename Func, typename... Args>
-Task<T> RunOnThreadPool(Func&& func, Args&&... args) {
+template <typename T, typename Callable>
+Task<T> SubmitToThreadPool(Callable task, const TaskTag* tag) {
     auto promise = std::make_shared<CoroutinePromise<T>>();
-    auto task = std::bind(std::forward<Func>(func), std::forward<Args>(args)...);
 
     auto work = [promise, task]() mutable {
         try {
@@ -107,15 +212,230 @@ Task<T> RunOnThreadPool(Func&& func, Args&&... args) {
         }
     };
 
-    Scheduler::GetThreadPool().Submit(std::move(work));
+    // The VEH abandons a throwing task's fiber, so the failure reaches the promise through onDone
+    auto onDone = [promise](std::shared_ptr<ExceptionState> exState) {
+        if (exState && HasException(exState.get())) {
+            promise->SetException(exState);
+        }
+    };
+
+    Scheduler::GetThreadPool().Submit(std::move(work), tag, std::move(onDone));
     return Task<T>(promise);
 }
 
+template <typename T, typename Func, typename = EnableIfNotTaskTag<Func>, typename... Args>
+Task<T> RunOnThreadPool(Func&& func, Args&&... args) {
+    return SubmitToThreadPool<T>(std::bind(std::forward<Func>(func), std::forward<Args>(args)...), nullptr);
+}
+
+// Pool queue wait and run time of the work are accounted to the tag
 template <typename T, typename Func, typename... Args>
+Task<T> RunOnThreadPool(const TaskTag& tag, Func&& func, Args&&... args) {
+    return SubmitToThreadPool<T>(std::bind(std::forward<Func>(func), std::forward<Args>(args)...), &tag);
+}
+
+template <typename U, typename Callable>
+void CompletePromiseWith(const std::shared_ptr<CoroutinePromise<U>>& promise, Callable&& callable) {
+    if constexpr (std::is_void_v<U>) {
+        callable();
+        promise->SetResult();
+    } else {
+        promise->SetResult(callable());
+    }
+}
+
+template <typename U>
+void ForwardCompletion(const std::shared_ptr<CoroutinePromise<U>>& source, const std::shared_ptr<CoroutinePromise<U>>& target) {
+    source->OnCompleted([source, target]() {
+        if (source->HasException()) {
+            target->SetException(source->GetExceptionState());
+            return;
+        }
+        CompletePromiseWith(target, [&]() { return source->GetResult(); });
+    });
+}
+
+// Owns a step bound for another scheduler; if that scheduler is gone or drops it unrun, the step's task fails
+template <typename U>
+struct PostedContinuation {
+    PostedContinuation(std::shared_ptr<CoroutinePromise<U>> p, std::function<U()> s) : next(std::move(p)), step(std::move(s)) {}
+
+    ~PostedContinuation() {
+        if (!launched) {
+            next->SetException(MakeExceptionState(std::make_exception_ptr(std::runtime_error("Then: target scheduler was destroyed before running the continuation"))));
+        }
+    }
+
+    std::shared_ptr<CoroutinePromise<U>> next;
+    std::function<U()> step;
+    bool launched = false;
+};
+
+template <typename T>
+template <typename U, typename Step>
+void Task<T>::RunContinuation(const std::shared_ptr<CoroutinePromise<U>>& next, Step step) {
+    // With no running coroutine the VEH lets the exception unwind, so an ordinary catch charges it to
+    // this step instead of to whichever coroutine completed the antecedent
+    Scheduler* scheduler = GetCurrentScheduler();
+    Coroutine* running = scheduler ? std::exchange(scheduler->runningCoroutine, nullptr) : nullptr;
+    std::optional<std::conditional_t<std::is_void_v<U>, bool, U>> value;
+    std::exception_ptr error;
+    try {
+        if constexpr (std::is_void_v<U>) {
+            step();
+            value.emplace(true);
+        } else {
+            value.emplace(step());
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    if (scheduler) {
+        scheduler->runningCoroutine = running;
+    }
+
+    // Completed outside the try: continuations of next run from here and handle their own failures
+    if (error) {
+        next->SetException(MakeExceptionState(error));
+    } else if constexpr (std::is_void_v<U>) {
+        next->SetResult();
+    } else {
+        next->SetResult(std::move(*value));
+    }
+}
+
+template <typename T>
+template <typename Func>
+Task<typename ContinuationResult<T, Func>::type> Task<T>::Then(Func&& func) const {
+    using U = typename ContinuationResult<T, Func>::type;
+    auto next = std::make_shared<CoroutinePromise<U>>();
+    auto antecedent = promise;
+
+    antecedent->OnCompleted([antecedent, next, func = std::forward<Func>(func)]() mutable {
+        if (antecedent->HasException()) {
+            next->SetException(antecedent->GetExceptionState());
+            return;
+        }
+        RunContinuation(next, [antecedent, func = std::move(func)]() mutable -> U {
+            if constexpr (std::is_void_v<T>) {
+                return func();
+            } else {
+                return func(antecedent->GetResult());
+            }
+        });
+    });
+    return Task<U>(next);
+}
+
+template <typename T>
+template <typename Func>
+Task<typename ContinuationResult<T, Func>::type> Task<T>::Then(Scheduler& scheduler, Func&& func) const {
+    using U = typename ContinuationResult<T, Func>::type;
+    if (scheduler.isThreadPool) {
+        throw std::runtime_error("Then(scheduler) needs an event-loop scheduler; use RunOnThreadPool for the pool.");
+    }
+    auto next = std::make_shared<CoroutinePromise<U>>();
+    auto antecedent = promise;
+    // The anchor, not the scheduler, is kept alive: ~Scheduler clears it, so a late completion cannot reach a dead scheduler
+    std::shared_ptr<Scheduler::PostAnchor> anchor = scheduler.postAnchor;
+
+    antecedent->OnCompleted([antecedent, next, anchor, func = std::forward<Func>(func)]() mutable {
+        if (antecedent->HasException()) {
+            next->SetException(antecedent->GetExceptionState());
+            return;
+        }
+        auto posted = std::make_shared<PostedContinuation<U>>(next, [antecedent, func]() mutable -> U {
+            if constexpr (std::is_void_v<T>) {
+                return func();
+            } else {
+                return func(antecedent->GetResult());
+            }
+        });
+        std::unique_lock<std::mutex> lock(anchor->mutex);
+        Scheduler* target = anchor->scheduler;
+        if (!target) {
+            // Already destroyed: releasing the last reference fails next, outside the anchor lock
+            lock.unlock();
+            posted.reset();
+            return;
+        }
+        if (GetCurrentScheduler() == target) {
+            posted->launched = true;
+            target->Launch(posted->next, std::move(posted->step));
+        } else {
+            target->Post([target, posted]() {
+                posted->launched = true;
+                target->Launch(posted->next, std::move(posted->step));
+            });
+        }
+    });
+    return Task<U>(next);
+}
+
+template <typename T>
+template <typename Func>
+Task<std::invoke_result_t<Func, Task<T>>> Task<T>::ContinueWith(Func&& func) const {
+    using U = std::invoke_result_t<Func, Task<T>>;
+    auto next = std::make_shared<CoroutinePromise<U>>();
+    auto antecedent = promise;
+
+    antecedent->OnCompleted([antecedent, next, func = std::forward<Func>(func)]() mutable {
+        RunContinuation(next, [antecedent, func = std::move(func)]() mutable -> U { return func(Task<T>(antecedent)); });
+    });
+    return Task<U>(next);
+}
+
+template <typename T>
+auto Task<T>::Unwrap() const {
+    static_assert(IsTask<T>::value, "Unwrap is only available on Task<Task<U>>");
+    using Inner = typename std::decay_t<decltype(std::declval<T>().GetPromise())>::element_type;
+    auto unwrapped = std::make_shared<Inner>();
+    auto outer = promise;
+
+    outer->OnCompleted([outer, unwrapped]() {
+        if (outer->HasException()) {
+            unwrapped->SetException(outer->GetExceptionState());
+            return;
+        }
+        ForwardCompletion(outer->GetResult().GetPromise(), unwrapped);
+    });
+    return Task<std::decay_t<decltype(std::declval<Inner>().GetResult())>>(unwrapped);
+}
+
+template <typename Func>
+decltype(auto) RunBlocking(Func&& func) {
+    BlockingRegion region;
+    return std::forward<Func>(func)();
+}
+
+template <typename T, typename Func, typename, typename... Args>
 std::shared_ptr<CoroutinePromise<T>> Scheduler::CreateCoroutine(Func&& func, Args&&... args) {
+    auto promise = std::make_shared<CoroutinePromise<T>>();
+    Launch(promise, std::bind(std::forward<Func>(func), std::forward<Args>(args)...));
+    return promise;
+}
+
+template <typename T, typename Func, typename... Args>
+std::shared_ptr<CoroutinePromise<T>> Scheduler::CreateCoroutine(const TaskTag& tag, Func&& func, Args&&... args) {
     auto promise = std::make_shared<CoroutinePromise<T>>();
     auto task = std::bind(std::forward<Func>(func), std::forward<Args>(args)...);
 
+    if (ShouldOffloadTag(tag)) {
+        // The watchdog has seen this tag hog its scheduler: run the body on the pool and only wait here
+        DebugPrint("[Scheduler::CreateCoroutine] Offloading heavy tag '%s' to the thread pool\n", tag.name);
+        const TaskTag* heavyTag = &tag;
+        Launch(promise, [task, heavyTag]() mutable -> T {
+            auto offloaded = RunOnThreadPool<T>(*heavyTag, std::move(task));
+            return Await(offloaded);
+        }, &tag);
+    } else {
+        Launch(promise, std::move(task), &tag);
+    }
+    return promise;
+}
+
+template <typename T, typename Callable>
+void Scheduler::Launch(std::shared_ptr<CoroutinePromise<T>> promise, Callable task, const TaskTag* tag) {
     auto wrappedFunc = [promise, task]() mutable {
         try {
             if constexpr (std::is_void_v<T>) {
@@ -135,9 +455,9 @@ std::shared_ptr<CoroutinePromise<T>> Scheduler::CreateCoroutine(Func&& func, Arg
         }
     };
 
-    auto co = std::make_unique<Coroutine>(std::move(wrappedFunc), std::move(onDone), this);
+    CoroutinePtr co(new Coroutine(std::move(wrappedFunc), std::move(onDone), this));
     co->promiseHandle = promise;
-    runnableQueue.push_back(co.get());
+    co->tag = tag;
+    runnableQueue.Push(co.get());
     coroutines.push_back(std::move(co));
-    return promise;
 }
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "winAsync.h"
+
+// Structured fan-out. Children run as coroutines on the scheduler that created the group and never
+// outlive its scope. Their coroutine headers are carved from a group arena released in one shot when
+// the group is destroyed. The group itself is not thread-safe: use it from its own scheduler only.
+class TaskGroup {
+public:
+    // Must be created inside a running coroutine, which waits for the children at scope exit
+    TaskGroup();
+
+    // Waits for every child; a child error is only rethrown by Wait()
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename Func>
+    void Spawn(Func&& func) {
+        AddChildren(1, [body = std::forward<Func>(func)](size_t) mutable { body(); });
+    }
+
+    // Spawns count children running func(index): one arena block, one queue reservation, one shared body
+    template <typename Func>
+    void SpawnMany(size_t count, Func&& func) {
+        AddChildren(count, std::forward<Func>(func));
+    }
+
+    // Suspends until every child has finished, then rethrows the first child exception.
+    // The arena and bodies are released before the rethrow, since the scope's destructor will not run
+    void Wait();
+
+    // Children that have not started yet are skipped; running children may poll IsCancelled().
+    // A failing child cancels the group once the scheduler has reaped it, at the end of its run pass
+    void Cancel() { cancelled = true; }
+    bool IsCancelled() const { return cancelled; }
+    size_t Pending() const { return pending; }
+
+private:
+    struct Child;
+
+    // Bump allocator; nothing is freed until the group goes away or Wait rethrows
+    class Arena {
+    public:
+        void* Allocate(size_t bytes, size_t alignment);
+        void Release();
+
+    private:
+        static constexpr size_t kBlockBytes = 64 * 1024;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char* cursor = nullptr;
+        char* limit = nullptr;
+    };
+
+    void AddChildren(size_t count, std::function<void(size_t)> body);
+    void RunChild(Child* child);
+    void ChildDone(const std::shared_ptr<ExceptionState>& exState);
+    void WaitForChildren();
+
+    Scheduler* scheduler;
+    Arena arena;
+    std::deque<std::function<void(size_t)>> bodies;    // Stable addresses; children point at their batch's body
+    std::shared_ptr<ExceptionState> firstError;
+    Coroutine* waitingParent = nullptr;     // Parked in WaitForChildren until the last child is reaped
+    size_t pending = 0;
+    bool cancelled = false;
+};
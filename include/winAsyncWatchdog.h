@@ -0,0 +1,100 @@
+#pragma once
+
+#include "winAsync.h"
+#include <intrin.h>
+
+// Timestamp used on the switch path; converted with TicksPerMicrosecond() once a watchdog has calibrated it
+inline uint64_t ReadTicks() {
+    return __rdtsc();
+}
+
+struct HogReport {
+    static constexpr size_t kMaxFrames = 32;
+
+    const char* tag;                // "untagged" for coroutines created without a TaskTag
+    DWORD threadId;
+    double sliceMilliseconds;       // How long the coroutine had been running when it was sampled
+    size_t frameCount;
+    void* frames[kMaxFrames];       // Raw return addresses, innermost first; symbolize with DbgHelp if needed
+};
+
+struct TagSliceHistogram {
+    const char* tag;
+    uint64_t buckets[TagStats::kSliceBuckets];
+    uint64_t slices;
+    double maxSliceMicroseconds;
+    uint32_t hogReports;
+};
+
+struct TagProfile {
+    const char* tag;
+    uint64_t slices;                // Number of resumes
+    double cpuMicroseconds;         // Time between resume and the next switch back to the scheduler
+    double waitMicroseconds[TagStats::kWaitKinds];   // Indexed by WaitKind
+
+    double Wait(WaitKind kind) const { return waitMicroseconds[static_cast<size_t>(kind)]; }
+};
+
+struct WatchdogOptions {
+    std::chrono::milliseconds slice{50};            // Longest run between two yields before a coroutine is reported
+    std::chrono::milliseconds pollInterval{10};
+    bool offloadHeavyTags = false;                  // Debug aid: CreateCoroutine(tag, ...) runs repeat offenders on the pool
+    uint32_t heavyAfterReports = 3;
+    std::function<void(const HogReport&)> onHog;    // Called on the monitor thread; defaults to printing to stderr
+};
+
+// Monitors every event-loop Scheduler for coroutines that run too long without yielding.
+// While a watchdog exists, each resume publishes (tag, start tick) and records its slice length per tag.
+class HogWatchdog {
+public:
+    explicit HogWatchdog(WatchdogOptions options = WatchdogOptions());
+    ~HogWatchdog();
+
+    HogWatchdog(const HogWatchdog&) = delete;
+    HogWatchdog& operator=(const HogWatchdog&) = delete;
+
+    static bool IsActive() { return active.load(std::memory_order_relaxed); }
+
+    // Merges the per-scheduler tables, including those of schedulers that have already exited
+    static std::vector<TagSliceHistogram> SliceHistograms();
+
+    static double TicksPerMicrosecond();
+
+private:
+    friend class Scheduler;
+    friend bool ShouldOffloadTag(const TaskTag& tag);
+
+    static void RegisterScheduler(Scheduler* scheduler);
+    static void UnregisterScheduler(Scheduler* scheduler);
+    struct Sample;
+
+    void MonitorLoop();
+    void Inspect(Scheduler* scheduler, uint64_t now, Sample& sample, bool& found);
+    static void Unwind(Sample& sample);
+
+    static std::atomic<bool> active;
+    static std::atomic<bool> offloadHeavyTags;
+    static std::atomic<uint32_t> heavyAfterReports;
+
+    WatchdogOptions options;
+    uint64_t sliceTicks;
+    std::thread monitor;
+    std::mutex stopMutex;
+    std::condition_variable stopCondition;
+    bool stopping = false;
+};
+
+// Coroutine-level profile by TaskTag: CPU time plus ready, timer, I/O and pool wait.
+// Sampling profilers cannot attribute time across fiber switches; this is measured at the switches.
+class TaskProfiler {
+public:
+    static void Enable();
+    static void Disable();
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // Merges the per-scheduler tables, including those of schedulers that have already exited
+    static std::vector<TagProfile> Snapshot();
+
+private:
+    static std::atomic<bool> enabled;
+};
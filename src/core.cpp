@@ -0,0 +1,331 @@
+#include "winAsync.h"
+#include <windows.h>
+#include <stdexcept>
+
+namespace {
+    thread_local const CoreRuntime* currentRuntime = nullptr;
+    thread_local size_t currentCoreIndex = CoreRuntime::kNoCore;
+
+    bool MapCoreIndex(size_t index, PROCESSOR_NUMBER& processor) {
+        size_t total = 0;
+        WORD groups = GetActiveProcessorGroupCount();
+        for (WORD group = 0; group < groups; ++group) {
+            total += GetActiveProcessorCount(group);
+        }
+        if (total == 0) {
+            return false;
+        }
+
+        index %= total;
+        for (WORD group = 0; group < groups; ++group) {
+            DWORD count = GetActiveProcessorCount(group);
+            if (index < count) {
+                processor.Group = group;
+                processor.Number = static_cast<BYTE>(index);
+                processor.Reserved = 0;
+                return true;
+            }
+            index -= count;
+        }
+        return false;
+    }
+
+    DWORD NumaNodeForCore(size_t index) {
+        PROCESSOR_NUMBER processor;
+        USHORT node = 0;
+        if (MapCoreIndex(index, processor) && GetNumaProcessorNodeEx(&processor, &node)) {
+            return node;
+        }
+        return NUMA_NO_PREFERRED_NODE;
+    }
+}
+
+SpscMailbox::SpscMailbox(size_t capacity, DWORD numaNode) {
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    mask = size - 1;
+
+    size_t bytes = size * sizeof(std::function<void()>);
+    void* memory = nullptr;
+    if (numaNode != NUMA_NO_PREFERRED_NODE) {
+        memory = VirtualAllocExNuma(GetCurrentProcess(), nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, numaNode);
+    }
+    if (!memory) {
+        memory = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+    if (!memory) {
+        throw std::runtime_error("Failed to allocate mailbox storage");
+    }
+
+    slots = static_cast<std::function<void()>*>(memory);
+    for (size_t i = 0; i < size; ++i) {
+        new (&slots[i]) std::function<void()>();
+    }
+}
+
+SpscMailbox::~SpscMailbox() {
+    for (size_t i = 0; i <= mask; ++i) {
+        slots[i].~function();
+    }
+    VirtualFree(slots, 0, MEM_RELEASE);
+}
+
+bool SpscMailbox::TryPush(std::function<void()>& job) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) > mask) {
+        return false;
+    }
+    slots[t & mask] = std::move(job);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+bool SpscMailbox::TryPop(std::function<void()>& job) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire)) {
+        return false;
+    }
+    job = std::move(slots[h & mask]);
+    slots[h & mask] = nullptr;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+bool SpscMailbox::Empty() const {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+}
+
+struct CoreRuntime::Core {
+    Core(size_t i, size_t numCores) : index(i), numaNode(NumaNodeForCore(i)), inboundCount(numCores), inbound(new std::atomic<SpscMailbox*>[numCores]) {
+        for (size_t source = 0; source < numCores; ++source) {
+            inbound[source].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~Core() {
+        for (size_t source = 0; source < inboundCount; ++source) {
+            delete inbound[source].load(std::memory_order_relaxed);
+        }
+    }
+
+    size_t index;
+    DWORD numaNode;
+    std::thread thread;
+    Scheduler* scheduler = nullptr;
+    IoOperation wakeOp;
+    std::atomic<bool> ready{false};
+    std::atomic<bool> parked{false};
+    std::atomic<bool> stopping{false};
+
+    // Set by the pump once it stops accepting jobs; posting counts senders between their closed check and push
+    std::atomic<bool> closed{false};
+    std::atomic<size_t> posting{0};
+
+    // One SPSC ring per source core, created lazily by that core on first send
+    size_t inboundCount;
+    std::unique_ptr<std::atomic<SpscMailbox*>[]> inbound;
+
+    // Threads outside the runtime have no ring of their own and share this queue
+    std::mutex externalMutex;
+    std::deque<std::function<void()>> external;
+    std::atomic<bool> hasExternal{false};
+};
+
+CoreRuntime::CoreRuntime(size_t numCores, size_t capacity) : mailboxCapacity(capacity) {
+    if (numCores == 0) {
+        numCores = std::thread::hardware_concurrency();
+    }
+
+    for (size_t i = 0; i < numCores; ++i) {
+        cores.push_back(std::make_unique<Core>(i, numCores));
+    }
+    for (auto& core : cores) {
+        core->thread = std::thread(&CoreRuntime::CoreLoop, this, core.get());
+    }
+    for (auto& core : cores) {
+        while (!core->ready.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    DebugPrint("[CoreRuntime::CoreRuntime] Started %zu pinned cores\n", numCores);
+}
+
+CoreRuntime::~CoreRuntime() {
+    Stop();
+}
+
+size_t CoreRuntime::CoreCount() const {
+    return cores.size();
+}
+
+size_t CoreRuntime::CurrentCore() const {
+    return currentRuntime == this ? currentCoreIndex : kNoCore;
+}
+
+void CoreRuntime::Stop() {
+    if (stopped) {
+        return;
+    }
+    stopped = true;
+
+    for (auto& core : cores) {
+        core->stopping.store(true);
+        if (core->parked.exchange(false)) {
+            core->scheduler->PostCompletion(&core->wakeOp);
+        }
+    }
+    for (auto& core : cores) {
+        if (core->thread.joinable()) {
+            core->thread.join();
+        }
+    }
+}
+
+void CoreRuntime::Post(size_t index, std::function<void()> job) {
+    Core* target = cores[index].get();
+
+    // Announce the post before checking closed, so a closing pump waits for it to land and drains it
+    target->posting.fetch_add(1);
+    if (target->closed.load()) {
+        target->posting.fetch_sub(1);
+        throw std::runtime_error("CoreRuntime::Post: target core has stopped");
+    }
+
+    size_t source = CurrentCore();
+
+    if (source != kNoCore) {
+        SpscMailbox* mailbox = target->inbound[source].load(std::memory_order_acquire);
+        if (!mailbox) {
+            mailbox = new SpscMailbox(mailboxCapacity, target->numaNode);
+            target->inbound[source].store(mailbox, std::memory_order_release);
+        }
+
+        while (!mailbox->TryPush(job)) {
+            // Target is saturated: make sure it is draining and let this core make progress meanwhile
+            if (target->parked.exchange(false)) {
+                target->scheduler->PostCompletion(&target->wakeOp);
+            }
+            Scheduler* scheduler = GetCurrentScheduler();
+            if (scheduler && scheduler->GetRunningCoroutine()) {
+                Coroutine::YieldExecution();
+            } else {
+                SwitchToThread();
+            }
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(target->externalMutex);
+        target->external.push_back(std::move(job));
+        target->hasExternal.store(true, std::memory_order_release);
+    }
+
+    if (target->parked.exchange(false)) {
+        target->scheduler->PostCompletion(&target->wakeOp);
+    }
+    target->posting.fetch_sub(1);
+}
+
+void CoreRuntime::PinCurrentThread(size_t index) {
+    PROCESSOR_NUMBER processor;
+    if (!MapCoreIndex(index, processor)) {
+        return;
+    }
+
+    GROUP_AFFINITY affinity = {};
+    affinity.Group = processor.Group;
+    affinity.Mask = static_cast<KAFFINITY>(1) << processor.Number;
+    if (!SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr)) {
+        DebugPrint("[CoreRuntime::PinCurrentThread] Failed to pin core %zu\n", index);
+    }
+}
+
+void CoreRuntime::CoreLoop(Core* core) {
+    // Pin before anything is allocated so fiber stacks and scheduler state are first touched on the local node
+    PinCurrentThread(core->index);
+    currentRuntime = this;
+    currentCoreIndex = core->index;
+
+    Scheduler scheduler;
+    core->scheduler = &scheduler;
+    scheduler.CreateCoroutine<void>([this, core]() { PumpMailboxes(core); });
+    core->ready.store(true, std::memory_order_release);
+
+    scheduler.Run();
+
+    currentRuntime = nullptr;
+    currentCoreIndex = kNoCore;
+}
+
+void CoreRuntime::PumpMailboxes(Core* core) {
+    core->wakeOp.coroutine = core->scheduler->GetRunningCoroutine();
+
+    while (true) {
+        DrainMailboxes(core);
+        if (core->stopping.load()) {
+            CloseMailboxes(core);
+            return;
+        }
+
+        // Publish that we are about to park, then re-check so a concurrent Post cannot be missed
+        core->parked.store(true);
+        if ((HasPendingJobs(core) || core->stopping.load()) && core->parked.exchange(false)) {
+            continue;
+        }
+        Coroutine::SuspendExecution();
+    }
+}
+
+void CoreRuntime::CloseMailboxes(Core* core) {
+    core->closed.store(true);
+
+    // Senders that passed the closed check are still pushing, possibly into a full ring; keep draining until they land
+    while (core->posting.load() != 0) {
+        DrainMailboxes(core);
+        Coroutine::YieldExecution();
+    }
+    DrainMailboxes(core);
+    DebugPrint("[CoreRuntime::CloseMailboxes] Core %zu drained and closed\n", core->index);
+}
+
+bool CoreRuntime::DrainMailboxes(Core* core) {
+    bool ranAny = false;
+    std::function<void()> job;
+
+    for (size_t source = 0; source < core->inboundCount; ++source) {
+        SpscMailbox* mailbox = core->inbound[source].load(std::memory_order_acquire);
+        if (!mailbox) {
+            continue;
+        }
+        while (mailbox->TryPop(job)) {
+            job();
+            ranAny = true;
+        }
+    }
+
+    if (core->hasExternal.load(std::memory_order_acquire)) {
+        std::deque<std::function<void()>> pending;
+        {
+            std::lock_guard<std::mutex> lock(core->externalMutex);
+            pending.swap(core->external);
+            core->hasExternal.store(false, std::memory_order_relaxed);
+        }
+        for (auto& pendingJob : pending) {
+            pendingJob();
+            ranAny = true;
+        }
+    }
+
+    return ranAny;
+}
+
+bool CoreRuntime::HasPendingJobs(const Core* core) {
+    for (size_t source = 0; source < core->inboundCount; ++source) {
+        SpscMailbox* mailbox = core->inbound[source].load(std::memory_order_acquire);
+        if (mailbox && !mailbox->Empty()) {
+            return true;
+        }
+    }
+    return core->hasExternal.load(std::memory_order_acquire);
+}
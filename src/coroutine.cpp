@@ -4,6 +4,7 @@
 struct ExceptionState {
     bool hasException = false;
     EXCEPTION_RECORD exceptionRecord;
+    std::exception_ptr error;       // Set instead of the record for failures raised outside a coroutine
 };
 
 void CaptureException(ExceptionState* es, const EXCEPTION_RECORD& record) {
@@ -11,11 +12,25 @@ void CaptureException(ExceptionState* es, const EXCEPTION_RECORD& record) {
     es->exceptionRecord = record;
 }
 
+std::shared_ptr<ExceptionState> MakeExceptionState(std::exception_ptr error) {
+    auto es = std::make_shared<ExceptionState>();
+    es->hasException = true;
+    es->error = std::move(error);
+    return es;
+}
+
+std::shared_ptr<ExceptionState> MakeExceptionSlot() {
+    return std::make_shared<ExceptionState>();
+}
+
 bool HasException(const ExceptionState* es) {
     return es && es->hasException;
 }
 
 void RethrowIfExists(const ExceptionState* es) {
+    if (es && es->error) {
+        std::rethrow_exception(es->error);
+    }
     if (es && es->hasException) {
         RaiseException(
             es->exceptionRecord.ExceptionCode,
@@ -28,12 +43,30 @@ void RethrowIfExists(const ExceptionState* es) {
 
 void CoroutineTrampoline(void* arg);
 
-Coroutine::Coroutine(std::function<void()> f, std::function<void(std::shared_ptr<ExceptionState>)> onDoneCallback, Scheduler* s) : func(std::move(f)), onDone(std::move(onDoneCallback)), state(State::Ready), scheduler(s), exceptionState(std::make_shared<ExceptionState>()) {
-    DebugPrint("[Coroutine::Coroutine] Created fiber\n");
-    fiber = CreateFiber(0, (LPFIBER_START_ROUTINE)CoroutineTrampoline, this);
+Coroutine::Coroutine(std::function<void()> f, std::function<void(std::shared_ptr<ExceptionState>)> onDoneCallback, Scheduler* s) : func(std::move(f)), onDone(std::move(onDoneCallback)), state(State::Ready), scheduler(s) {
+    DebugPrint("[Coroutine::Coroutine] Created coroutine\n");
+    if (TaskProfiler::IsEnabled()) {
+        waitStartTicks = ReadTicks();
+    }
+}
+
+Coroutine::~Coroutine() {
+    if (fiber) {
+        DeleteFiber(fiber);
+    }
+}
+
+void CoroutineDeleter::operator()(Coroutine* co) const {
+    if (co->arenaOwned) {
+        co->~Coroutine();
+    } else {
+        delete co;
+    }
 }
 
-Coroutine::~Coroutine() = default;
+ExceptionState* Coroutine::ExceptionSlot() {
+    return exceptionState.get();
+}
 
 bool Coroutine::HasException() const {
     return ::HasException(exceptionState.get());
@@ -56,6 +89,9 @@ void Coroutine::SuspendExecution() {
     Scheduler* scheduler = GetCurrentScheduler();
     if (!scheduler) return;
 
+    if (scheduler->runningCoroutine) {
+        scheduler->runningCoroutine->waitKind = WaitKind::Io;
+    }
     scheduler->runningCoroutine = nullptr;
     SwitchToFiber(scheduler->mainFiber);
 }
@@ -74,9 +110,13 @@ void Coroutine::YieldExecution() {
     SwitchToFiber(s->mainFiber);
 }
 
+// Fibers are reused: each pass runs whichever coroutine the scheduler is resuming
 void CoroutineTrampoline(void* arg) {
-    Coroutine* co = static_cast<Coroutine*>(arg);
-    co->func();
-    co->state = Coroutine::State::Finished;
-    Coroutine::YieldExecution();
+    Scheduler* scheduler = static_cast<Scheduler*>(arg);
+    while (true) {
+        Coroutine* co = scheduler->runningCoroutine;
+        co->func();
+        co->state = Coroutine::State::Finished;
+        Coroutine::YieldExecution();
+    }
 }
\ No newline at end of file
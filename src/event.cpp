@@ -0,0 +1,228 @@
+#include "winAsync.h"
+#include <windows.h>
+
+AsyncWaiter::AsyncWaiter() : scheduler(nullptr) {
+    Scheduler* current = GetCurrentScheduler();
+    if (current && current->GetRunningCoroutine()) {
+        scheduler = current;
+        coroutine = current->GetRunningCoroutine();
+    }
+}
+
+void AsyncWaiter::Park() {
+    if (scheduler) {
+        // Only our own completion resumes a parked coroutine; the loop is just a guard
+        while (!completed) {
+            Coroutine::SuspendExecution();
+        }
+        return;
+    }
+    // Sleeps in the kernel until Release; WaitOnAddress may also return spuriously, hence the loop
+    bool notReleased = false;
+    while (!released.load(std::memory_order_acquire)) {
+        WaitOnAddress(&released, &notReleased, sizeof(notReleased), INFINITE);
+    }
+}
+
+void AsyncWaiter::Release() {
+    if (scheduler) {
+        DebugPrint("[AsyncWaiter::Release] Waking coroutine %p through its scheduler's completion port\n", coroutine);
+        scheduler->PostCompletion(this);
+    } else {
+        released.store(true, std::memory_order_release);
+        // Only the address is used to find the sleeper, so waking after the waiter has returned is harmless
+        WakeByAddressSingle(&released);
+    }
+}
+
+void AsyncWaiterQueue::Push(AsyncWaiter* waiter) {
+    waiter->next = nullptr;
+    if (tail) {
+        tail->next = waiter;
+    } else {
+        head = waiter;
+    }
+    tail = waiter;
+}
+
+AsyncWaiter* AsyncWaiterQueue::Pop() {
+    AsyncWaiter* waiter = head;
+    if (waiter) {
+        head = waiter->next;
+        if (!head) {
+            tail = nullptr;
+        }
+    }
+    return waiter;
+}
+
+AsyncWaiter* AsyncWaiterQueue::TakeAll() {
+    AsyncWaiter* all = head;
+    head = tail = nullptr;
+    return all;
+}
+
+namespace {
+    // Read next before releasing: a released waiter may return and take its node with it
+    void ReleaseAll(AsyncWaiter* waiter) {
+        while (waiter) {
+            AsyncWaiter* next = waiter->next;
+            waiter->Release();
+            waiter = next;
+        }
+    }
+}
+
+AsyncManualResetEvent::AsyncManualResetEvent(bool initiallySet) : state(initiallySet ? static_cast<void*>(this) : nullptr) {
+}
+
+void AsyncManualResetEvent::Set() {
+    void* previous = state.exchange(this, std::memory_order_acq_rel);
+    if (previous == this) {
+        return;
+    }
+
+    // Waiters were pushed newest first; release them in arrival order
+    AsyncWaiter* ordered = nullptr;
+    AsyncWaiter* waiter = static_cast<AsyncWaiter*>(previous);
+    while (waiter) {
+        AsyncWaiter* next = waiter->next;
+        waiter->next = ordered;
+        ordered = waiter;
+        waiter = next;
+    }
+    ReleaseAll(ordered);
+}
+
+void AsyncManualResetEvent::Reset() {
+    void* expected = this;
+    state.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed);
+}
+
+bool AsyncManualResetEvent::IsSet() const {
+    return state.load(std::memory_order_acquire) == this;
+}
+
+void AsyncManualResetEvent::Wait() {
+    void* current = state.load(std::memory_order_acquire);
+    if (current == this) {
+        return;
+    }
+
+    AsyncWaiter waiter;
+    do {
+        if (current == this) {
+            return;
+        }
+        waiter.next = static_cast<AsyncWaiter*>(current);
+    } while (!state.compare_exchange_weak(current, &waiter, std::memory_order_release, std::memory_order_acquire));
+    waiter.Park();
+}
+
+AsyncAutoResetEvent::AsyncAutoResetEvent(bool initiallySet) : state(initiallySet ? 1 : 0) {
+}
+
+void AsyncAutoResetEvent::Set() {
+    int64_t current = state.load(std::memory_order_acquire);
+    while (true) {
+        if (current == 1) {
+            return;
+        }
+        int64_t next = current == 0 ? 1 : current + 1;
+        if (state.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            if (current == 0) {
+                return;
+            }
+            break;
+        }
+    }
+
+    // The waiter counted itself while holding the lock and queued itself before unlocking
+    AsyncWaiter* waiter;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        waiter = waiters.Pop();
+    }
+    waiter->Release();
+}
+
+bool AsyncAutoResetEvent::TryWait() {
+    int64_t expected = 1;
+    return state.compare_exchange_strong(expected, 0, std::memory_order_acq_rel, std::memory_order_relaxed);
+}
+
+void AsyncAutoResetEvent::Wait() {
+    if (TryWait()) {
+        return;
+    }
+
+    AsyncWaiter waiter;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        int64_t current = state.load(std::memory_order_acquire);
+        while (true) {
+            if (current == 1) {
+                if (state.compare_exchange_weak(current, 0, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    return;
+                }
+                continue;
+            }
+            if (state.compare_exchange_weak(current, current - 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                break;
+            }
+        }
+        waiters.Push(&waiter);
+    }
+    waiter.Park();
+}
+
+AsyncLatch::AsyncLatch(ptrdiff_t count) : remaining(count), ready(count <= 0) {
+}
+
+void AsyncLatch::CountDown(ptrdiff_t n) {
+    ptrdiff_t before = remaining.fetch_sub(n, std::memory_order_acq_rel);
+    if (before > 0 && before - n <= 0) {
+        ready.Set();
+    }
+}
+
+void AsyncLatch::ArriveAndWait(ptrdiff_t n) {
+    CountDown(n);
+    ready.Wait();
+}
+
+AsyncBarrier::AsyncBarrier(size_t count, std::function<void()> onComplete) : participants(count), remaining(count), onPhaseComplete(std::move(onComplete)) {
+}
+
+void AsyncBarrier::ArriveAndWait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (--remaining == 0) {
+        CompletePhaseLocked(lock);
+        return;
+    }
+
+    AsyncWaiter waiter;
+    waiters.Push(&waiter);
+    lock.unlock();
+    waiter.Park();
+}
+
+void AsyncBarrier::ArriveAndDrop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    --participants;
+    if (--remaining == 0) {
+        CompletePhaseLocked(lock);
+    }
+}
+
+void AsyncBarrier::CompletePhaseLocked(std::unique_lock<std::mutex>& lock) {
+    remaining = participants;
+    AsyncWaiter* released = waiters.TakeAll();
+    lock.unlock();
+
+    // Everyone else is still parked, so the callback sees the phase's results without racing
+    if (onPhaseComplete) {
+        onPhaseComplete();
+    }
+    ReleaseAll(released);
+}
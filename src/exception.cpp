@@ -2,6 +2,7 @@
 #include <windows.h>
 
 LONG WINAPI Scheduler::VectoredExceptionHandler(PEXCEPTION_POINTERS ExceptionInfo) {
+    LogEnterExceptionHandler();
     DebugPrint("[Scheduler::VectoredExceptionHandler] Vectored Exception Handler triggered.\n");
     Scheduler* scheduler = GetCurrentScheduler();
     if (scheduler && scheduler->runningCoroutine) {
@@ -10,9 +11,10 @@ LONG WINAPI Scheduler::VectoredExceptionHandler(PEXCEPTION_POINTERS ExceptionInf
             // C++ exception
             DebugPrint("[Scheduler::VectoredExceptionHandler] C++ exception detected. Capturing...\n");
             Coroutine* co = scheduler->runningCoroutine;
-            CaptureException(co->exceptionState.get(), *ExceptionInfo->ExceptionRecord);
+            CaptureException(co->ExceptionSlot(), *ExceptionInfo->ExceptionRecord);
 
             DebugPrint("[Scheduler::VectoredExceptionHandler] Switching to main fiber to handle exception.\n");
+            LogLeaveExceptionHandler();
             SwitchToFiber(scheduler->mainFiber);
 
             return EXCEPTION_CONTINUE_EXECUTION;
@@ -20,5 +22,6 @@ LONG WINAPI Scheduler::VectoredExceptionHandler(PEXCEPTION_POINTERS ExceptionInf
     }
 
     DebugPrint("[Scheduler::VectoredExceptionHandler] Exception not handled by our handler. Continuing search.\n");
+    LogLeaveExceptionHandler();
     return EXCEPTION_CONTINUE_SEARCH;
 }
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "winAsync.h"
+#include <windows.h>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    constexpr size_t kUnbufferedAlignment = 4096;
+}
+
+AsyncFileReader::AsyncFileReader(const std::wstring& path, const FileReaderOptions& opts) : options(opts) {
+    Scheduler* scheduler = GetCurrentScheduler();
+    if (!scheduler) {
+        throw std::runtime_error("AsyncFileReader must be created on a scheduler thread.");
+    }
+
+    if (options.unbuffered) {
+        options.chunkSize = (options.chunkSize + kUnbufferedAlignment - 1) / kUnbufferedAlignment * kUnbufferedAlignment;
+    }
+    options.readahead = std::max<size_t>(1, options.readahead);
+    options.maxBufferedChunks = std::max(options.maxBufferedChunks, options.readahead);
+
+    DWORD flags = FILE_FLAG_OVERLAPPED | (options.unbuffered ? FILE_FLAG_NO_BUFFERING : FILE_FLAG_SEQUENTIAL_SCAN);
+    file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("AsyncFileReader failed to open file, error " + std::to_string(GetLastError()));
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error("AsyncFileReader failed to query file size");
+    }
+    fileSize = static_cast<uint64_t>(size.QuadPart);
+    scheduler->RegisterHandle(file);
+
+    // VirtualAlloc returns page-aligned memory, which satisfies unbuffered I/O alignment
+    slots.resize(options.maxBufferedChunks);
+    for (Slot& slot : slots) {
+        slot.buffer = static_cast<char*>(VirtualAlloc(nullptr, options.chunkSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+        if (!slot.buffer) {
+            throw std::runtime_error("AsyncFileReader failed to allocate read buffer");
+        }
+    }
+}
+
+AsyncFileReader::~AsyncFileReader() {
+    bool pending = false;
+    for (Slot& slot : slots) {
+        pending = pending || (slot.state == SlotState::Reading && !slot.op.completed);
+    }
+
+    Scheduler* scheduler = GetCurrentScheduler();
+    bool canWait = scheduler && scheduler->GetRunningCoroutine();
+    if (pending) {
+        CancelIoEx(file, nullptr);
+        if (canWait) {
+            // Completion packets still reference the slots; wait for each before freeing them
+            for (Slot& slot : slots) {
+                while (slot.state == SlotState::Reading && !slot.op.completed) {
+                    slot.op.coroutine = scheduler->GetRunningCoroutine();
+                    Coroutine::SuspendExecution();
+                }
+                slot.op.coroutine = nullptr;
+            }
+        }
+    }
+
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+    if (pending && !canWait) {
+        // No coroutine to wait on: leak the buffers rather than let a late completion touch freed memory
+        DebugPrint("[AsyncFileReader::~AsyncFileReader] Destroyed outside a coroutine with reads in flight; leaking buffers\n");
+        new std::vector<Slot>(std::move(slots));
+        return;
+    }
+    for (Slot& slot : slots) {
+        VirtualFree(slot.buffer, 0, MEM_RELEASE);
+    }
+}
+
+uint64_t AsyncFileReader::Size() const {
+    return fileSize;
+}
+
+void AsyncFileReader::IssueRead(Slot& slot) {
+    slot.offset = nextOffset;
+    slot.state = SlotState::Reading;
+    slot.op.Offset = static_cast<DWORD>(nextOffset & 0xFFFFFFFFull);
+    slot.op.OffsetHigh = static_cast<DWORD>(nextOffset >> 32);
+    slot.op.coroutine = nullptr;
+    slot.op.completed = false;
+    slot.op.bytesTransferred = 0;
+    slot.op.errorCode = 0;
+    nextOffset += options.chunkSize;
+
+    if (!ReadFile(file, slot.buffer, static_cast<DWORD>(options.chunkSize), nullptr, &slot.op)) {
+        DWORD error = GetLastError();
+        if (error != ERROR_IO_PENDING) {
+            // Synchronous failure: no completion packet will arrive
+            slot.op.errorCode = error;
+            slot.op.completed = true;
+        }
+    }
+}
+
+void AsyncFileReader::Refill() {
+    size_t inFlight = 0;
+    for (const Slot& slot : slots) {
+        if (slot.state == SlotState::Reading && !slot.op.completed) {
+            ++inFlight;
+        }
+    }
+
+    // Slots are issued and consumed in ring order, so a non-free slot at issueIndex means the buffer bound is reached
+    while (inFlight < options.readahead && nextOffset < fileSize && slots[issueIndex].state == SlotState::Free) {
+        IssueRead(slots[issueIndex]);
+        issueIndex = (issueIndex + 1) % slots.size();
+        ++inFlight;
+    }
+}
+
+bool AsyncFileReader::Next(Chunk& chunk) {
+    Scheduler* scheduler = GetCurrentScheduler();
+    if (!scheduler || !scheduler->GetRunningCoroutine()) {
+        throw std::runtime_error("AsyncFileReader::Next must be called from within a running coroutine");
+    }
+
+    for (Slot& slot : slots) {
+        if (slot.state == SlotState::Held) {
+            slot.state = SlotState::Free;
+        }
+    }
+    Refill();
+
+    Slot& slot = slots[consumeIndex];
+    if (slot.state == SlotState::Free) {
+        return false;
+    }
+
+    while (!slot.op.completed) {
+        slot.op.coroutine = scheduler->GetRunningCoroutine();
+        Coroutine::SuspendExecution();
+    }
+    slot.op.coroutine = nullptr;
+
+    if (slot.op.errorCode != 0 && slot.op.errorCode != ERROR_HANDLE_EOF) {
+        slot.state = SlotState::Free;
+        throw std::runtime_error("AsyncFileReader read failed with error " + std::to_string(slot.op.errorCode));
+    }
+
+    // Top up the pipeline before handing the chunk over so the disk works while the caller processes it
+    slot.state = SlotState::Held;
+    Refill();
+
+    chunk.data = slot.buffer;
+    chunk.size = static_cast<size_t>(std::min<uint64_t>(slot.op.bytesTransferred, fileSize - slot.offset));
+    chunk.offset = slot.offset;
+    consumeIndex = (consumeIndex + 1) % slots.size();
+    return chunk.size > 0;
+}
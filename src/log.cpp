@@ -0,0 +1,405 @@
+#include "winAsync.h"
+#include <windows.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <string>
+
+namespace {
+    constexpr size_t kRingBytes = size_t(1) << 18;
+    constexpr size_t kMaxSpareRings = 4;
+    const char* const kLevelNames[] = {"TRACE", "DEBUG", "INFO ", "WARN ", "ERROR"};
+
+    struct RecordHeader {
+        uint32_t argBytes;
+        LogLevel level;
+        uint8_t argCount;
+        DWORD threadId;
+        uint64_t ticks;
+        const char* format;
+    };
+
+    // Byte ring with exactly one producer (the owning thread) and one consumer (the logger thread)
+    class LogRing {
+    public:
+        LogRing() : buffer(new char[kRingBytes]) {}
+
+        bool TryWrite(const RecordHeader& header, const char* args) {
+            size_t total = sizeof(header) + header.argBytes;
+            size_t t = tail.load(std::memory_order_relaxed);
+            if (kRingBytes - (t - head.load(std::memory_order_acquire)) < total) {
+                return false;
+            }
+            CopyIn(t, &header, sizeof(header));
+            CopyIn(t + sizeof(header), args, header.argBytes);
+            tail.store(t + total, std::memory_order_release);
+            return true;
+        }
+
+        bool TryRead(RecordHeader& header, char* args) {
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            CopyOut(h, &header, sizeof(header));
+            CopyOut(h + sizeof(header), args, header.argBytes);
+            head.store(h + sizeof(header) + header.argBytes, std::memory_order_release);
+            return true;
+        }
+
+        bool Empty() const {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+
+        std::atomic<bool> orphaned{false};
+
+    private:
+        void CopyIn(size_t position, const void* source, size_t bytes) {
+            size_t offset = position & (kRingBytes - 1);
+            size_t first = std::min(bytes, kRingBytes - offset);
+            std::memcpy(buffer.get() + offset, source, first);
+            std::memcpy(buffer.get(), static_cast<const char*>(source) + first, bytes - first);
+        }
+
+        void CopyOut(size_t position, void* destination, size_t bytes) const {
+            size_t offset = position & (kRingBytes - 1);
+            size_t first = std::min(bytes, kRingBytes - offset);
+            std::memcpy(destination, buffer.get() + offset, first);
+            std::memcpy(static_cast<char*>(destination) + first, buffer.get(), bytes - first);
+        }
+
+        std::unique_ptr<char[]> buffer;
+        alignas(64) std::atomic<size_t> head{0};
+        alignas(64) std::atomic<size_t> tail{0};
+    };
+
+    class ArgReader {
+    public:
+        ArgReader(const char* d, size_t s) : data(d), size(s) {}
+
+        bool Next(uint8_t& type, uint64_t& bits, std::string& text) {
+            if (offset >= size) {
+                return false;
+            }
+            type = static_cast<uint8_t>(data[offset++]);
+            if (type == LogRecordBuilder::String) {
+                size_t length = static_cast<uint8_t>(data[offset++]);
+                text.assign(data + offset, length);
+                offset += length;
+            } else {
+                std::memcpy(&bits, data + offset, sizeof(bits));
+                offset += sizeof(bits);
+            }
+            return true;
+        }
+
+    private:
+        const char* data;
+        size_t size;
+        size_t offset = 0;
+    };
+
+    // printf-compatible formatting of a recorded argument list. Each conversion spec is formatted on its
+    // own, with the length modifier re-derived from the recorded type, so %d, %zu, %lu etc. all work.
+    void FormatMessage(std::string& out, const char* format, const char* args, size_t argBytes) {
+        ArgReader reader(args, argBytes);
+        std::string text;
+        char spec[40];
+        char buffer[512];
+
+        for (const char* p = format; *p; ++p) {
+            if (*p != '%') {
+                out += *p;
+                continue;
+            }
+            if (p[1] == '%') {
+                out += '%';
+                ++p;
+                continue;
+            }
+
+            const char* start = p++;
+            size_t n = 0;
+            spec[n++] = '%';
+            while (*p && std::strchr("-+ #0", *p) && n < 16) {
+                spec[n++] = *p++;
+            }
+            while (*p && (std::isdigit(static_cast<unsigned char>(*p)) || *p == '.') && n < 32) {
+                spec[n++] = *p++;
+            }
+            while (*p && std::strchr("hlLzjtqI", *p)) {
+                bool msvcWidth = *p == 'I';
+                ++p;
+                while (msvcWidth && std::isdigit(static_cast<unsigned char>(*p))) {
+                    ++p;
+                }
+            }
+            char conversion = *p;
+            if (!conversion) {
+                out.append(start);
+                break;
+            }
+
+            uint8_t type = 0;
+            uint64_t bits = 0;
+            if (!reader.Next(type, bits, text)) {
+                out.append(start, p + 1 - start);
+                continue;
+            }
+
+            int written = 0;
+            switch (type) {
+            case LogRecordBuilder::Signed:
+            case LogRecordBuilder::Unsigned:
+                if (conversion == 'c') {
+                    spec[n++] = 'c';
+                    spec[n] = '\0';
+                    written = snprintf(buffer, sizeof(buffer), spec, static_cast<int>(bits));
+                    break;
+                }
+                if (type == LogRecordBuilder::Signed) {
+                    spec[n++] = 'l';
+                    spec[n++] = 'l';
+                    spec[n++] = std::strchr("dixXou", conversion) ? conversion : 'd';
+                    spec[n] = '\0';
+                    written = snprintf(buffer, sizeof(buffer), spec, static_cast<long long>(bits));
+                    break;
+                }
+                spec[n++] = 'l';
+                spec[n++] = 'l';
+                spec[n++] = std::strchr("xXo", conversion) ? conversion : 'u';
+                spec[n] = '\0';
+                written = snprintf(buffer, sizeof(buffer), spec, static_cast<unsigned long long>(bits));
+                break;
+            case LogRecordBuilder::Double: {
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                spec[n++] = std::strchr("fFeEgGaA", conversion) ? conversion : 'g';
+                spec[n] = '\0';
+                written = snprintf(buffer, sizeof(buffer), spec, value);
+                break;
+            }
+            case LogRecordBuilder::Pointer:
+                spec[n++] = 'p';
+                spec[n] = '\0';
+                written = snprintf(buffer, sizeof(buffer), spec, reinterpret_cast<void*>(static_cast<uintptr_t>(bits)));
+                break;
+            default:
+                spec[n++] = 's';
+                spec[n] = '\0';
+                written = snprintf(buffer, sizeof(buffer), spec, text.c_str());
+                break;
+            }
+            if (written > 0) {
+                out.append(buffer, std::min(static_cast<size_t>(written), sizeof(buffer) - 1));
+            }
+        }
+    }
+
+    class LoggerThread {
+    public:
+        LoggerThread() : sink(stdout), startTicks(ReadTicks()) {
+            worker = std::thread(&LoggerThread::Loop, this);
+        }
+
+        LogRing* RegisterRing() {
+            std::shared_ptr<LogRing> ring;
+            {
+                // Threads that come and go, like elastic pool workers, reuse the rings of exited ones
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!spareRings.empty()) {
+                    ring = std::move(spareRings.back());
+                    spareRings.pop_back();
+                    ring->orphaned.store(false, std::memory_order_relaxed);
+                    rings.push_back(ring);
+                    return ring.get();
+                }
+            }
+            ring = std::make_shared<LogRing>();
+            std::lock_guard<std::mutex> lock(mutex);
+            rings.push_back(ring);
+            return ring.get();
+        }
+
+        void Flush() {
+            std::unique_lock<std::mutex> lock(mutex);
+            uint64_t ticket = ++flushRequested;
+            Wake();
+            flushed.wait(lock, [&] { return flushCompleted >= ticket; });
+        }
+
+        // Called by a producer after publishing a record; lock-free, and a syscall only when the consumer sleeps
+        void NotifyWritten() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping.load(std::memory_order_relaxed) && sleeping.exchange(false, std::memory_order_acq_rel)) {
+                Wake();
+            }
+        }
+
+        std::atomic<FILE*> sink;
+
+    private:
+        void Wake() {
+            wakeSequence.fetch_add(1, std::memory_order_release);
+            WakeByAddressSingle(&wakeSequence);
+        }
+
+        bool AnyPendingLocked() const {
+            return std::any_of(rings.begin(), rings.end(), [](const std::shared_ptr<LogRing>& ring) { return !ring->Empty(); });
+        }
+
+        void Loop() {
+            std::vector<std::shared_ptr<LogRing>> snapshot;
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                uint64_t serving = flushRequested;
+                snapshot = rings;
+                lock.unlock();
+
+                bool wrote = Drain(snapshot);
+
+                lock.lock();
+                // Rings of exited threads leave once the consumer has emptied them; a few are kept for reuse
+                auto retired = std::stable_partition(rings.begin(), rings.end(), [](const std::shared_ptr<LogRing>& ring) {
+                    return !(ring->orphaned.load(std::memory_order_acquire) && ring->Empty());
+                });
+                for (auto it = retired; it != rings.end() && spareRings.size() < kMaxSpareRings; ++it) {
+                    spareRings.push_back(std::move(*it));
+                }
+                rings.erase(retired, rings.end());
+                flushCompleted = serving;
+                flushed.notify_all();
+
+                if (!wrote && flushRequested == serving) {
+                    // Announce the sleep, then look once more: a producer either sees the flag or its record is seen here
+                    uint32_t sequence = wakeSequence.load(std::memory_order_acquire);
+                    sleeping.store(true, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (!AnyPendingLocked()) {
+                        lock.unlock();
+                        WaitOnAddress(&wakeSequence, &sequence, sizeof(sequence), INFINITE);
+                        lock.lock();
+                    }
+                    sleeping.store(false, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool Drain(const std::vector<std::shared_ptr<LogRing>>& snapshot) {
+            RecordHeader header;
+            char args[LogRecordBuilder::kMaxArgBytes];
+            lines.clear();
+
+            for (const auto& ring : snapshot) {
+                while (ring->TryRead(header, args)) {
+                    std::string line;
+                    char prefix[64];
+                    double seconds = header.ticks > startTicks ? (header.ticks - startTicks) / HogWatchdog::TicksPerMicrosecond() / 1e6 : 0.0;
+                    snprintf(prefix, sizeof(prefix), "[%12.6f T%-5lu %s] ", seconds, static_cast<unsigned long>(header.threadId), kLevelNames[static_cast<size_t>(header.level)]);
+                    line = prefix;
+                    FormatMessage(line, header.format, args, header.argBytes);
+                    if (line.back() != '\n') {
+                        line += '\n';
+                    }
+                    lines.emplace_back(header.ticks, std::move(line));
+                }
+            }
+            if (lines.empty()) {
+                return false;
+            }
+
+            // Each ring is ordered already; interleave threads by timestamp within this pass
+            std::stable_sort(lines.begin(), lines.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            FILE* out = sink.load();
+            for (const auto& line : lines) {
+                fwrite(line.second.data(), 1, line.second.size(), out);
+            }
+            fflush(out);
+            return true;
+        }
+
+        uint64_t startTicks;
+        std::mutex mutex;
+        std::condition_variable flushed;
+        std::vector<std::shared_ptr<LogRing>> rings;
+        std::vector<std::shared_ptr<LogRing>> spareRings;
+        std::atomic<bool> sleeping{false};
+        std::atomic<uint32_t> wakeSequence{0};      // Waited on with WaitOnAddress while every ring is empty
+        std::vector<std::pair<uint64_t, std::string>> lines;
+        uint64_t flushRequested = 0;
+        uint64_t flushCompleted = 0;
+        std::thread worker;
+    };
+
+    // Never destroyed: pool workers and static destructors may still log during process exit
+    LoggerThread& Logger() {
+        static LoggerThread* logger = [] {
+            LoggerThread* instance = new LoggerThread();
+            std::atexit([] { AsyncLogger::Flush(); });
+            return instance;
+        }();
+        return *logger;
+    }
+
+    struct ThreadRing {
+        ~ThreadRing() {
+            if (ring) {
+                ring->orphaned.store(true, std::memory_order_release);
+            }
+        }
+
+        LogRing* ring = nullptr;
+        DWORD threadId = 0;
+        bool inExceptionHandler = false;
+    };
+
+    thread_local ThreadRing threadRing;
+
+    // Outside the logger so that counting a drop never constructs it
+    std::atomic<uint64_t> droppedRecords{0};
+}
+
+void LogEnterExceptionHandler() {
+    threadRing.inExceptionHandler = true;
+}
+
+void LogLeaveExceptionHandler() {
+    threadRing.inExceptionHandler = false;
+}
+
+void LogSubmit(LogLevel level, const char* format, const LogRecordBuilder& args) {
+    if (!threadRing.ring) {
+        // Creating the ring allocates and may start the logger, which the VEH must never do
+        if (threadRing.inExceptionHandler) {
+            droppedRecords.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        AsyncLogger::RegisterThread();
+    }
+
+    RecordHeader header{static_cast<uint32_t>(args.Size()), level, args.Count(), threadRing.threadId, ReadTicks(), format};
+    if (!threadRing.ring->TryWrite(header, args.Data())) {
+        droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Logger().NotifyWritten();
+}
+
+void AsyncLogger::RegisterThread() {
+    if (!threadRing.ring) {
+        threadRing.threadId = GetCurrentThreadId();
+        threadRing.ring = Logger().RegisterRing();
+    }
+}
+
+void AsyncLogger::SetSink(FILE* sink) {
+    Logger().sink.store(sink ? sink : stdout);
+}
+
+void AsyncLogger::Flush() {
+    Logger().Flush();
+}
+
+uint64_t AsyncLogger::DroppedRecords() {
+    return droppedRecords.load(std::memory_order_relaxed);
+}
@@ -6,8 +6,22 @@
 
 namespace {
     thread_local Scheduler* currentScheduler = nullptr;
+    thread_local Scheduler* currentPool = nullptr;
+
+    ThreadPoolOptions NormalizeOptions(ThreadPoolOptions options) {
+        if (options.minThreads == 0) {
+            options.minThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        if (options.maxThreads == 0) {
+            options.maxThreads = options.minThreads * 4;
+        }
+        options.maxThreads = std::max(options.maxThreads, options.minThreads);
+        return options;
+    }
 }
 
+void CoroutineTrampoline(void* arg);
+
 Scheduler* GetCurrentScheduler() {
     return currentScheduler;
 }
@@ -17,7 +31,7 @@ void SetCurrentScheduler(Scheduler* scheduler) {
 }
 
 Scheduler& Scheduler::GetThreadPool() {
-    static Scheduler threadPool(std::thread::hardware_concurrency());
+    static Scheduler threadPool(ThreadPoolOptions{});
     return threadPool;
 }
 
@@ -34,16 +48,34 @@ Scheduler::Scheduler() : runningCoroutine(nullptr), vehHandle(nullptr), pendingE
     }
     vehHandle = AddVectoredExceptionHandler(1, VectoredExceptionHandler);
 
+    // A real handle (not the GetCurrentThread pseudo-handle) lets the watchdog suspend and sample this thread
+    DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &threadHandle, 0, FALSE, DUPLICATE_SAME_ACCESS);
+    threadId = GetCurrentThreadId();
+    postAnchor = std::make_shared<PostAnchor>();
+    postAnchor->scheduler = this;
+    HogWatchdog::RegisterScheduler(this);
+
     DebugPrint("[Scheduler::Scheduler] Scheduler created and VEH registered\n");
 }
 
-Scheduler::Scheduler(size_t numThreads) : runningCoroutine(nullptr), vehHandle(nullptr), pendingException(nullptr), isThreadPool(true), stop(false) {
-    for (size_t i = 0; i < numThreads; ++i) {
-        workers.emplace_back(&Scheduler::WorkerLoop, this);
+Scheduler::Scheduler(size_t numThreads) : Scheduler(ThreadPoolOptions{numThreads, numThreads}) {
+}
+
+Scheduler::Scheduler(const ThreadPoolOptions& options) : mainFiber(nullptr), iocpHandle(nullptr), runningCoroutine(nullptr), vehHandle(nullptr), pendingException(nullptr), isThreadPool(true), poolOptions(NormalizeOptions(options)), stop(false) {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (workers.size() < poolOptions.minThreads) {
+        SpawnWorkerLocked();
     }
+    growthMonitor = std::thread(&Scheduler::GrowthMonitorLoop, this);
 }
 
 Scheduler::~Scheduler() {
+    if (postAnchor) {
+        // Continuations completing from now on fail their tasks instead of posting here
+        std::lock_guard<std::mutex> lock(postAnchor->mutex);
+        postAnchor->scheduler = nullptr;
+    }
+
     if (vehHandle) {
         RemoveVectoredExceptionHandler(vehHandle);
         DebugPrint("[Scheduler::~Scheduler] VEH unregistered\n");
@@ -56,27 +88,274 @@ Scheduler::~Scheduler() {
     if (isThreadPool) {
         Stop();
     } else {
+        HogWatchdog::UnregisterScheduler(this);
+        for (void* fiber : idleFibers) {
+            DeleteFiber(fiber);
+        }
+        if (threadHandle) {
+            CloseHandle(threadHandle);
+        }
         currentScheduler = nullptr;
+
+        // Jobs posted after the last Run never execute. Dropping them here, with no current scheduler,
+        // lets a pending Then fail its task and any continuations of that task run in place
+        std::vector<std::function<void()>> dropped;
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            dropped.swap(inbox);
+        }
+        dropped.clear();
         ConvertFiberToThread();
     }
 }
 
-void Scheduler::Submit(std::function<void()> func) {
+void Scheduler::Submit(std::function<void()> func, const TaskTag* tag, std::function<void(std::shared_ptr<ExceptionState>)> onDone) {
     if (!isThreadPool) {
         throw std::runtime_error("Submit is only for thread pool schedulers.");
-    } else {
+    }
+
+    Scheduler* caller = GetCurrentScheduler();
+    const bool fromCoroutine = caller && caller != this && caller->runningCoroutine;
+    while (!TryEnqueue(func, tag, onDone)) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (stop || !QueueFullLocked()) {
+            continue;
+        }
+        if (currentPool == this) {
+            // Waiting here would park a worker this queue needs to drain; run func on this worker instead
+            lock.unlock();
+            caller->Add(std::move(func), tag, std::move(onDone));
+            return;
+        }
+        if (fromCoroutine) {
+            // Queue is full: park the submitting coroutine, not its thread, until a worker takes a task
+            SpaceWaiter waiter;
+            waiter.scheduler = caller;
+            waiter.op.coroutine = caller->runningCoroutine;
+            spaceWaiters.push_back(&waiter);
+            lock.unlock();
+            while (!waiter.op.completed) {
+                Coroutine::SuspendExecution();
+            }
+        } else {
+            notFull.wait(lock, [this] { return stop || !QueueFullLocked(); });
+        }
+    }
+}
+
+bool Scheduler::TrySubmit(std::function<void()>& func, const TaskTag* tag) {
+    if (!isThreadPool) {
+        throw std::runtime_error("TrySubmit is only for thread pool schedulers.");
+    }
+
+    std::function<void(std::shared_ptr<ExceptionState>)> onDone;
+    return TryEnqueue(func, tag, onDone);
+}
+
+bool Scheduler::TryEnqueue(std::function<void()>& func, const TaskTag* tag, std::function<void(std::shared_ptr<ExceptionState>)>& onDone) {
+    {
         std::unique_lock<std::mutex> lock(queueMutex);
-        tasks.push_back(std::move(func));
+        if (stop) {
+            throw std::runtime_error("Thread pool has been stopped.");
+        }
+        if (QueueFullLocked()) {
+            return false;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        tasks.push_back({std::move(func), std::move(onDone), now, tag});
+        queuedTasks.fetch_add(1, std::memory_order_release);
+        if (ShouldGrowLocked(now)) {
+            SpawnWorkerLocked();
+        }
+        NotifyGrowthMonitorLocked();
     }
     condition.notify_one();
+    JoinRetiredWorkers();
+    return true;
+}
+
+bool Scheduler::QueueFullLocked() const {
+    return poolOptions.maxQueueLength != 0 && tasks.size() >= poolOptions.maxQueueLength;
+}
+
+void Scheduler::WakeSpaceWaitersLocked(size_t count) {
+    while (count-- > 0 && !spaceWaiters.empty()) {
+        SpaceWaiter* waiter = spaceWaiters.front();
+        spaceWaiters.pop_front();
+        waiter->scheduler->PostCompletion(&waiter->op);
+    }
+}
+
+void Scheduler::Configure(const ThreadPoolOptions& options) {
+    if (!isThreadPool) {
+        throw std::runtime_error("Configure is only for thread pool schedulers.");
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        poolOptions = NormalizeOptions(options);
+        while (RunnableWorkersLocked() < poolOptions.minThreads) {
+            SpawnWorkerLocked();
+        }
+        WakeSpaceWaitersLocked(spaceWaiters.size());
+    }
+    // Wake everyone so surplus workers can retire and blocked producers re-check the queue bound
+    condition.notify_all();
+    notFull.notify_all();
+    JoinRetiredWorkers();
+}
+
+size_t Scheduler::PendingTasks() const {
+    return queuedTasks.load(std::memory_order_relaxed);
 }
 
-void Scheduler::Add(std::function<void()> func) {
-    auto co = std::make_unique<Coroutine>(std::move(func), nullptr, this);
-    runnableQueue.push_back(co.get());
+size_t Scheduler::WorkerCount() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    return workers.size();
+}
+
+size_t Scheduler::RunnableWorkersLocked() const {
+    return workers.size() - blockedWorkers;
+}
+
+bool Scheduler::ShouldGrowLocked(std::chrono::steady_clock::time_point now) const {
+    if (stop || tasks.empty() || idleWorkers > 0 || RunnableWorkersLocked() >= poolOptions.maxThreads) {
+        return false;
+    }
+    return now - tasks.front().enqueueTime >= poolOptions.growthLatency;
+}
+
+void Scheduler::NotifyGrowthMonitorLocked() {
+    // Only a parked monitor needs the signal; while it times a backlog it re-checks by itself
+    if (monitorParked && !tasks.empty() && idleWorkers == 0) {
+        monitorParked = false;
+        monitorWake.notify_one();
+    }
+}
+
+void Scheduler::GrowthMonitorLoop() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (!stop) {
+        if (tasks.empty() || idleWorkers > 0) {
+            // A worker will take the queue; enqueue and dequeue signal once a backlog has nobody to take it
+            monitorParked = true;
+            monitorWake.wait(lock, [this] { return stop || !monitorParked; });
+            continue;
+        }
+
+        // Every worker is busy, so no dequeue will come along to notice the oldest task aging
+        const auto now = std::chrono::steady_clock::now();
+        auto deadline = tasks.front().enqueueTime + poolOptions.growthLatency;
+        if (ShouldGrowLocked(now)) {
+            SpawnWorkerLocked();
+            deadline = now + poolOptions.growthLatency;
+        } else if (deadline <= now) {
+            // At maxThreads: nothing to spawn until a worker retires or Configure raises the cap
+            deadline = now + poolOptions.growthLatency;
+        }
+        monitorWake.wait_until(lock, deadline);
+    }
+}
+
+void Scheduler::SpawnWorkerLocked() {
+    DebugPrint("[Scheduler::SpawnWorkerLocked] Spawning worker %zu\n", workers.size() + 1);
+    workers.emplace_back(&Scheduler::WorkerLoop, this);
+}
+
+void Scheduler::RetireWorkerLocked() {
+    auto self = std::find_if(workers.begin(), workers.end(), [](const std::thread& worker) {
+        return worker.get_id() == std::this_thread::get_id();
+    });
+    if (self != workers.end()) {
+        DebugPrint("[Scheduler::RetireWorkerLocked] Retiring worker, %zu remain\n", workers.size() - 1);
+        retiredWorkers.push_back(std::move(*self));
+        workers.erase(self);
+    }
+}
+
+void Scheduler::JoinRetiredWorkers() {
+    std::vector<std::thread> finished;
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        finished.swap(retiredWorkers);
+    }
+    for (std::thread& worker : finished) {
+        if (worker.joinable() && worker.get_id() != std::this_thread::get_id()) {
+            worker.join();
+        } else if (worker.joinable()) {
+            worker.detach();
+        }
+    }
+}
+
+void Scheduler::EnterBlocking() {
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        ++blockedWorkers;
+        // Keep the number of workers able to run tasks at the configured floor
+        if (!stop && RunnableWorkersLocked() < poolOptions.minThreads && blockedWorkers <= poolOptions.maxBlockingThreads) {
+            SpawnWorkerLocked();
+        }
+    }
+    JoinRetiredWorkers();
+}
+
+void Scheduler::LeaveBlocking() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    --blockedWorkers;
+}
+
+BlockingRegion::BlockingRegion() : pool(currentPool) {
+    if (pool) {
+        pool->EnterBlocking();
+    }
+}
+
+BlockingRegion::~BlockingRegion() {
+    if (pool) {
+        pool->LeaveBlocking();
+    }
+}
+
+void Scheduler::Add(std::function<void()> func, const TaskTag* tag, std::function<void(std::shared_ptr<ExceptionState>)> onDone) {
+    CoroutinePtr co(new Coroutine(std::move(func), std::move(onDone), this));
+    co->tag = tag;
+    runnableQueue.Push(co.get());
     coroutines.push_back(std::move(co));
 }
 
+void Scheduler::Post(std::function<void()> func) {
+    if (isThreadPool) {
+        throw std::runtime_error("Post is only for coroutine schedulers; use Submit for the thread pool.");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        inbox.push_back(std::move(func));
+    }
+    // Only the first post after a drain needs to wake a parked event loop
+    if (!inboxPending.exchange(true, std::memory_order_acq_rel)) {
+        PostQueuedCompletionStatus(iocpHandle, 0, kInboxWakeKey, nullptr);
+    }
+}
+
+void Scheduler::DrainInbox() {
+    if (!inboxPending.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::vector<std::function<void()>> pending;
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        pending.swap(inbox);
+        inboxPending.store(false, std::memory_order_release);
+    }
+    for (auto& func : pending) {
+        func();
+    }
+}
+
 void Scheduler::RegisterHandle(HANDLE handle) {
     if (CreateIoCompletionPort(handle, iocpHandle, 0, 0) != iocpHandle) {
         throw std::runtime_error("Failed to associate handle with IOCP");
@@ -86,12 +365,24 @@ void Scheduler::RegisterHandle(HANDLE handle) {
 void Scheduler::Stop() {
     if (!isThreadPool) {
         return;
-    } else {
+    }
+
+    std::vector<std::thread> toJoin;
+    {
         std::unique_lock<std::mutex> lock(queueMutex);
         stop = true;
+        toJoin.swap(workers);
+        toJoin.push_back(std::move(growthMonitor));
+        for (std::thread& worker : retiredWorkers) {
+            toJoin.push_back(std::move(worker));
+        }
+        retiredWorkers.clear();
+        WakeSpaceWaitersLocked(spaceWaiters.size());
     }
     condition.notify_all();
-    for (std::thread& worker : workers) {
+    notFull.notify_all();
+    monitorWake.notify_all();
+    for (std::thread& worker : toJoin) {
         if (worker.joinable()) {
             worker.join();
         }
@@ -101,19 +392,18 @@ void Scheduler::Stop() {
 void Scheduler::Run() {
     DebugPrint("[Scheduler::Run] Starting scheduler with %zu initial coroutines\n", coroutines.size());
 
-    while (!coroutines.empty()) {
+    while (!coroutines.empty() || inboxPending.load(std::memory_order_acquire)) {
+        DrainInbox();
+
         auto now = std::chrono::steady_clock::now();
         while (!timers.empty() && timers.top().wakeupTime <= now) {
             TimerNode node = timers.top();
             timers.pop();
-            runnableQueue.push_back(node.coroutine);
+            runnableQueue.Push(node.coroutine);
             sleepingCoroutines.erase(node.coroutine);
         }
 
-        while (!runnableQueue.empty()) {
-            Coroutine* co = runnableQueue.front();
-            runnableQueue.pop_front();
-
+        while (Coroutine* co = runnableQueue.Pop()) {
             if (co->state != Coroutine::State::Finished) {
                 DebugPrint("[Scheduler::Run] Resuming coroutine %p in state %d\n", co, static_cast<int>(co->state));
                 Resume(co);
@@ -123,29 +413,44 @@ void Scheduler::Run() {
         for (const auto& co : coroutines) {
             if (co->state == Coroutine::State::Suspended) {
                 if (sleepingCoroutines.find(co.get()) == sleepingCoroutines.end()) {
-                    runnableQueue.push_back(co.get());
+                    runnableQueue.Push(co.get());
                 }
             }
         }
 
-        coroutines.erase(std::remove_if(coroutines.begin(), coroutines.end(),
-            [](const std::unique_ptr<Coroutine>& co) {
-                if (co->state == Coroutine::State::Finished) {
-                    DebugPrint("[Scheduler::Run] Cleaning up finished coroutine %p\n", co.get());
-                    if (co->onDone) {
-                        co->onDone(co->exceptionState);
-                    }
-                    return true;
-                }
-                return false;
-            }), coroutines.end());
+        if (!runnableQueue.Empty()) {
+            // Yielding coroutines keep the queue busy; still pick up completions so parked ones are not starved
+            while (DequeueCompletion(0)) {
+            }
+        }
 
-        if (coroutines.empty()) {
+        // Detach finished coroutines first: onDone may run continuations that create new coroutines
+        std::vector<CoroutinePtr> finished;
+        size_t kept = 0;
+        for (size_t i = 0; i < coroutines.size(); ++i) {
+            if (coroutines[i]->state == Coroutine::State::Finished) {
+                finished.push_back(std::move(coroutines[i]));
+            } else if (kept != i) {
+                coroutines[kept++] = std::move(coroutines[i]);
+            } else {
+                ++kept;
+            }
+        }
+        coroutines.resize(kept);
+        for (const auto& co : finished) {
+            DebugPrint("[Scheduler::Run] Cleaning up finished coroutine %p\n", co.get());
+            if (co->onDone) {
+                co->onDone(co->exceptionState);
+            }
+        }
+        finished.clear();
+
+        if (coroutines.empty() && !inboxPending.load(std::memory_order_acquire)) {
             DebugPrint("[Scheduler::Run] No more coroutines to run. Exiting.\n");
             break;
         }
 
-        if (runnableQueue.empty()) {
+        if (runnableQueue.Empty()) {
             DWORD timeout = INFINITE;
             if (!timers.empty()) {
                 auto nextWakeup = timers.top().wakeupTime;
@@ -156,43 +461,218 @@ void Scheduler::Run() {
                     timeout = 0;
                 }
             }
-            
-            DWORD bytesTransferred;
-            ULONG_PTR completionKey;
-            OVERLAPPED* overlapped;
-
-            DebugPrint("[Scheduler::Run] Waiting for IO events with timeout %u ms\n", timeout);
-            BOOL result = GetQueuedCompletionStatus(iocpHandle, &bytesTransferred, &completionKey, &overlapped, timeout);
-
-            if (result && overlapped) {
-                IoOperation* op = static_cast<IoOperation*>(overlapped);
-                DebugPrint("[Scheduler::Run] IO completed for coroutine %p, resuming.\n", op->coroutine);
-                runnableQueue.push_back(op->coroutine);
-            } else if (!result && overlapped) {
-                IoOperation* op = static_cast<IoOperation*>(overlapped);
-                DebugPrint("[Scheduler::Run] IO failed for coroutine %p, resuming.\n", op->coroutine);
-                runnableQueue.push_back(op->coroutine);
-            } else {
-                DebugPrint("[Scheduler::Run] Wait timed out or woken up.\n");
-            }
+
+            WaitForEvents(timeout);
         }
     }
 }
 
+bool Scheduler::DequeueCompletion(DWORD timeout) {
+    DWORD bytesTransferred;
+    ULONG_PTR completionKey;
+    OVERLAPPED* overlapped;
+
+    BOOL result = GetQueuedCompletionStatus(iocpHandle, &bytesTransferred, &completionKey, &overlapped, timeout);
+
+    if (result && !overlapped && completionKey == kInboxWakeKey) {
+        DebugPrint("[Scheduler::DequeueCompletion] Woken up by a cross-thread post.\n");
+        return true;
+    }
+    if (overlapped) {
+        IoOperation* op = static_cast<IoOperation*>(overlapped);
+        op->bytesTransferred = bytesTransferred;
+        op->errorCode = result ? 0 : GetLastError();
+        op->completed = true;
+        if (result) {
+            DebugPrint("[Scheduler::DequeueCompletion] IO completed for coroutine %p, resuming.\n", op->coroutine);
+        } else {
+            DebugPrint("[Scheduler::DequeueCompletion] IO failed for coroutine %p, resuming.\n", op->coroutine);
+        }
+        if (op->coroutine) {
+            runnableQueue.Push(op->coroutine);
+        }
+        return true;
+    }
+    return false;
+}
+
+void Scheduler::WaitForEvents(DWORD timeout) {
+    const auto idleStart = std::chrono::steady_clock::now();
+    const IdlePolicy policy = idlePolicy.load(std::memory_order_relaxed);
+
+    if (policy == IdlePolicy::Block || timeout == 0) {
+        DebugPrint("[Scheduler::WaitForEvents] Waiting for IO events with timeout %u ms\n", timeout);
+        if (DequeueCompletion(timeout)) {
+            idleTuner.Record(std::chrono::steady_clock::now() - idleStart);
+        } else {
+            DebugPrint("[Scheduler::WaitForEvents] Wait timed out or woken up.\n");
+        }
+        return;
+    }
+
+    // A timer that becomes due ends the idle period just like a completion would
+    const bool hasDeadline = timeout != INFINITE;
+    const auto deadline = idleStart + std::chrono::milliseconds(hasDeadline ? timeout : 0);
+    const auto spinEnd = policy == IdlePolicy::BusyPoll ? std::chrono::steady_clock::time_point::max() : idleStart + idleTuner.Budget(maxSpinMicroseconds.load(std::memory_order_relaxed));
+
+    while (true) {
+        if (DequeueCompletion(0)) {
+            idleTuner.Record(std::chrono::steady_clock::now() - idleStart);
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (hasDeadline && now >= deadline) {
+            return;
+        }
+        if (now >= spinEnd) {
+            break;
+        }
+        YieldProcessor();
+    }
+
+    DWORD remaining = INFINITE;
+    if (hasDeadline) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        remaining = left.count() > 0 ? static_cast<DWORD>(left.count()) : 0;
+    }
+
+    DebugPrint("[Scheduler::WaitForEvents] Spin budget exhausted, parking with timeout %u ms\n", remaining);
+    if (DequeueCompletion(remaining)) {
+        idleTuner.Record(std::chrono::steady_clock::now() - idleStart);
+    }
+}
+
+void Scheduler::RunnableRing::Grow(size_t minimum) {
+    size_t capacity = std::max<size_t>(slots.size() * 2, 64);
+    while (capacity < minimum) {
+        capacity *= 2;
+    }
+    std::vector<Coroutine*> grown(capacity);
+    for (size_t i = head; i != tail; ++i) {
+        grown[i - head] = slots[i & (slots.size() - 1)];
+    }
+    tail -= head;
+    head = 0;
+    slots.swap(grown);
+}
+
+void Scheduler::IdleSpinTuner::Record(std::chrono::steady_clock::duration idleTime) {
+    double sample = std::chrono::duration<double, std::micro>(idleTime).count();
+    averageIdleMicroseconds += (sample - averageIdleMicroseconds) / 8.0;
+}
+
+std::chrono::microseconds Scheduler::IdleSpinTuner::Budget(uint32_t maxSpinMicroseconds) const {
+    // Spinning only pays off if events usually arrive before the budget runs out
+    if (averageIdleMicroseconds > maxSpinMicroseconds) {
+        return std::chrono::microseconds(0);
+    }
+    double budget = std::min(averageIdleMicroseconds * 2.0, static_cast<double>(maxSpinMicroseconds));
+    return std::chrono::microseconds(static_cast<int64_t>(budget) + 1);
+}
+
+void Scheduler::PostCompletion(IoOperation* op) {
+    if (!PostQueuedCompletionStatus(iocpHandle, 0, 0, op)) {
+        throw std::runtime_error("Failed to post completion to IOCP");
+    }
+}
+
+void Scheduler::SetIdlePolicy(IdlePolicy policy, uint32_t maxSpin) {
+    maxSpinMicroseconds.store(maxSpin, std::memory_order_relaxed);
+    idlePolicy.store(policy, std::memory_order_relaxed);
+}
+
+IdlePolicy Scheduler::GetIdlePolicy() const {
+    return idlePolicy.load(std::memory_order_relaxed);
+}
+
 void Scheduler::Resume(Coroutine* co) {
     if (!co) return;
+    if (!co->fiber) {
+        co->fiber = AcquireFiber();
+    }
+    if (!co->exceptionState) {
+        co->exceptionState = AcquireExceptionSlot();
+    }
 
     runningCoroutine = co;
     co->state = Coroutine::State::Running;
 
+    // With no watchdog or profiler the switch path only pays for these relaxed loads
+    const bool profiled = TaskProfiler::IsEnabled();
+    const bool watched = profiled || HogWatchdog::IsActive();
+    uint64_t resumeTicks = 0;
+    if (watched) {
+        resumeTicks = ReadTicks();
+        if (profiled) {
+            RecordWait(co, resumeTicks);
+        }
+        runSlot.resumeTicks.store(resumeTicks, std::memory_order_relaxed);
+        runSlot.tag.store(co->tag, std::memory_order_relaxed);
+        runSlot.sequence.store(runSlot.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        runSlot.running.store(true, std::memory_order_release);
+    }
+
     SwitchToFiber(co->fiber);
     DebugPrint("[Scheduler::Resume] Returned from coroutine context. Checking for exceptions.\n");
 
+    if (watched) {
+        uint64_t suspendTicks = ReadTicks();
+        runSlot.running.store(false, std::memory_order_relaxed);
+        RecordSlice(co, suspendTicks - resumeTicks);
+        // The coroutine set waitKind on its way out if it is sleeping or parked; otherwise it is ready again
+        co->waitStartTicks = suspendTicks;
+    }
+
     runningCoroutine = nullptr;
     if (co->HasException()) {
         DebugPrint("[Scheduler::Resume] Coroutine has an exception. Setting pendingException.\n");
         pendingException = co;
         co->state = Coroutine::State::Finished;
+    } else if (co->state == Coroutine::State::Finished) {
+        // A clean finish hands its unused slot to the next coroutine along with the fiber; onDone then sees null
+        RecycleFiber(co);
+        RecycleExceptionSlot(std::move(co->exceptionState));
+    }
+}
+
+void* Scheduler::AcquireFiber() {
+    if (!idleFibers.empty()) {
+        void* fiber = idleFibers.back();
+        idleFibers.pop_back();
+        return fiber;
+    }
+    void* fiber = CreateFiber(0, (LPFIBER_START_ROUTINE)CoroutineTrampoline, this);
+    if (!fiber) {
+        throw std::runtime_error("Failed to create coroutine fiber");
+    }
+    return fiber;
+}
+
+void Scheduler::RecycleFiber(Coroutine* co) {
+    // A cleanly finished fiber waits at the top of its trampoline loop for the next coroutine.
+    // Fibers left inside the VEH handler are not reusable and are deleted with their coroutine
+    if (idleFibers.size() < kMaxIdleFibers) {
+        idleFibers.push_back(co->fiber);
+    } else {
+        DeleteFiber(co->fiber);
+    }
+    co->fiber = nullptr;
+}
+
+std::shared_ptr<ExceptionState> Scheduler::AcquireExceptionSlot() {
+    if (!idleExceptionSlots.empty()) {
+        std::shared_ptr<ExceptionState> slot = std::move(idleExceptionSlots.back());
+        idleExceptionSlots.pop_back();
+        return slot;
+    }
+    return MakeExceptionSlot();
+}
+
+void Scheduler::RecycleExceptionSlot(std::shared_ptr<ExceptionState> slot) {
+    // A slot still referenced elsewhere could be written by its next coroutine while being read
+    if (slot.use_count() == 1 && idleExceptionSlots.size() < kMaxIdleFibers) {
+        idleExceptionSlots.push_back(std::move(slot));
     }
 }
 
@@ -210,21 +690,69 @@ Coroutine* Scheduler::PollException() {
 void Scheduler::WorkerLoop() {
     Scheduler localScheduler;
     SetCurrentScheduler(&localScheduler);
+    currentPool = this;
+    IdleSpinTuner workerTuner;
 
     while (true) {
+        const IdlePolicy policy = idlePolicy.load(std::memory_order_relaxed);
+        const auto idleStart = std::chrono::steady_clock::now();
+        if (policy != IdlePolicy::Block && queuedTasks.load(std::memory_order_acquire) == 0) {
+            const auto spinEnd = policy == IdlePolicy::BusyPoll ? std::chrono::steady_clock::time_point::max() : idleStart + workerTuner.Budget(maxSpinMicroseconds.load(std::memory_order_relaxed));
+            while (queuedTasks.load(std::memory_order_acquire) == 0 && !stop.load(std::memory_order_relaxed) && idlePolicy.load(std::memory_order_relaxed) == policy && std::chrono::steady_clock::now() < spinEnd) {
+                YieldProcessor();
+            }
+        }
+
         std::function<void()> task;
+        std::function<void(std::shared_ptr<ExceptionState>)> taskDone;
+        const TaskTag* taskTag = nullptr;
+        std::chrono::steady_clock::duration queueWait{};
         {
             std::unique_lock<std::mutex> lock(queueMutex);
-            condition.wait(lock, [this] { return stop || !tasks.empty(); });
+            ++idleWorkers;
+            bool hasWork = condition.wait_for(lock, poolOptions.idleTimeout, [this] { return stop || !tasks.empty(); });
+            --idleWorkers;
             if (stop && tasks.empty()) {
                 return;
             }
-            task = std::move(tasks.front());
+            if (!hasWork) {
+                if (RunnableWorkersLocked() > poolOptions.minThreads) {
+                    RetireWorkerLocked();
+                    return;
+                }
+                continue;
+            }
+
+            task = std::move(tasks.front().func);
+            taskDone = std::move(tasks.front().onDone);
+            taskTag = tasks.front().tag;
+            queueWait = std::chrono::steady_clock::now() - tasks.front().enqueueTime;
             tasks.pop_front();
+            queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            WakeSpaceWaitersLocked(1);
+
+            // The next task has already waited too long: the pool is falling behind
+            if (ShouldGrowLocked(std::chrono::steady_clock::now())) {
+                SpawnWorkerLocked();
+            }
+            NotifyGrowthMonitorLocked();
         }
+        notFull.notify_one();
+        workerTuner.Record(std::chrono::steady_clock::now() - idleStart);
 
-        localScheduler.Add(std::move(task));
+        if (TaskProfiler::IsEnabled()) {
+            localScheduler.RecordPoolWait(taskTag, queueWait);
+        }
+        localScheduler.Add(std::move(task), taskTag, std::move(taskDone));
         localScheduler.Run();
+
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            if (RunnableWorkersLocked() > poolOptions.maxThreads) {
+                RetireWorkerLocked();
+                return;
+            }
+        }
     }
 }
 
@@ -236,6 +764,7 @@ void Scheduler::AsyncSleep(uint32_t milliseconds) {
     Coroutine* co = scheduler->runningCoroutine;
     scheduler->timers.push({wakeupTime, co});
     scheduler->sleepingCoroutines.insert(co);
+    co->waitKind = WaitKind::Timer;
     
     Coroutine::YieldExecution();
 }
\ No newline at end of file
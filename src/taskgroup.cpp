@@ -0,0 +1,114 @@
+#include "winAsync.h"
+#include <windows.h>
+#include <algorithm>
+
+struct TaskGroup::Child {
+    Child(TaskGroup* g, const std::function<void(size_t)>* b, size_t i, Scheduler* s)
+        : group(g), body(b), index(i),
+          coroutine([this]() { group->RunChild(this); }, [this](std::shared_ptr<ExceptionState> exState) { group->ChildDone(exState); }, s) {
+        coroutine.arenaOwned = true;
+    }
+
+    // Captures are a single pointer, so neither std::function allocates
+    TaskGroup* group;
+    const std::function<void(size_t)>* body;
+    size_t index;
+    Coroutine coroutine;
+};
+
+void TaskGroup::Arena::Release() {
+    blocks.clear();
+    blocks.shrink_to_fit();
+    cursor = nullptr;
+    limit = nullptr;
+}
+
+void* TaskGroup::Arena::Allocate(size_t bytes, size_t alignment) {
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    if (!cursor || aligned + bytes > reinterpret_cast<uintptr_t>(limit)) {
+        // A large batch gets a block of its own, so SpawnMany(n) costs one allocation
+        size_t size = std::max(bytes + alignment, kBlockBytes);
+        blocks.emplace_back(new char[size]);
+        cursor = blocks.back().get();
+        limit = cursor + size;
+        aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    }
+    cursor = reinterpret_cast<char*>(aligned + bytes);
+    return reinterpret_cast<void*>(aligned);
+}
+
+TaskGroup::TaskGroup() : scheduler(GetCurrentScheduler()) {
+    if (!scheduler || !scheduler->GetRunningCoroutine()) {
+        throw std::runtime_error("TaskGroup must be created from within a running coroutine.");
+    }
+}
+
+TaskGroup::~TaskGroup() {
+    // Children reference the arena and this object until the scheduler has cleaned them up
+    WaitForChildren();
+}
+
+void TaskGroup::AddChildren(size_t count, std::function<void(size_t)> body) {
+    if (count == 0) {
+        return;
+    }
+
+    bodies.push_back(std::move(body));
+    const std::function<void(size_t)>* shared = &bodies.back();
+    Child* children = static_cast<Child*>(arena.Allocate(count * sizeof(Child), alignof(Child)));
+
+    size_t needed = scheduler->coroutines.size() + count;
+    if (scheduler->coroutines.capacity() < needed) {
+        scheduler->coroutines.reserve(std::max(needed, scheduler->coroutines.capacity() * 2));
+    }
+    scheduler->runnableQueue.Reserve(scheduler->runnableQueue.Size() + count);
+
+    for (size_t i = 0; i < count; ++i) {
+        Child* child = new (children + i) Child(this, shared, i, scheduler);
+        scheduler->runnableQueue.Push(&child->coroutine);
+        scheduler->coroutines.emplace_back(&child->coroutine);
+    }
+    pending += count;
+    DebugPrint("[TaskGroup::AddChildren] Spawned %zu children, %zu pending\n", count, pending);
+}
+
+void TaskGroup::RunChild(Child* child) {
+    if (cancelled) {
+        return;
+    }
+    try {
+        (*child->body)(child->index);
+    } catch (...) {
+        // Exception is handled by VEH, this just prevents crash
+    }
+}
+
+void TaskGroup::ChildDone(const std::shared_ptr<ExceptionState>& exState) {
+    if (exState && HasException(exState.get()) && !firstError) {
+        DebugPrint("[TaskGroup::ChildDone] Child failed, cancelling the remaining children\n");
+        firstError = exState;
+        cancelled = true;
+    }
+    if (--pending == 0 && waitingParent) {
+        scheduler->MakeRunnable(std::exchange(waitingParent, nullptr));
+    }
+}
+
+void TaskGroup::WaitForChildren() {
+    // onDone runs during the scheduler's cleanup pass, after which the children have been destroyed.
+    // The parent stays off the run queue until the last of them, so a loop waiting on I/O can block
+    while (pending > 0) {
+        waitingParent = scheduler->GetRunningCoroutine();
+        Coroutine::SuspendExecution();
+    }
+}
+
+void TaskGroup::Wait() {
+    WaitForChildren();
+    if (firstError) {
+        // The rethrow abandons this coroutine's stack, so ~TaskGroup never runs: free the children first
+        arena.Release();
+        std::deque<std::function<void(size_t)>>().swap(bodies);
+        RethrowIfExists(firstError.get());
+    }
+}
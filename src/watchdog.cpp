@@ -0,0 +1,369 @@
+#include "winAsync.h"
+#include <windows.h>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+std::atomic<bool> HogWatchdog::active{false};
+std::atomic<bool> HogWatchdog::offloadHeavyTags{false};
+std::atomic<uint32_t> HogWatchdog::heavyAfterReports{0};
+std::atomic<bool> TaskProfiler::enabled{false};
+
+// One hog, captured while its thread was suspended and unwound after the thread was resumed
+struct HogWatchdog::Sample {
+    static constexpr size_t kMaxStackCopy = 64 * 1024;
+    static constexpr size_t kStackSlack = 4096;     // Stop this close to the end of a truncated copy
+
+    // Sized up front: the suspended thread may hold the heap lock, so the capture must not allocate
+    Sample() : stack(kMaxStackCopy) {}
+
+    HogReport report;
+    CONTEXT context;
+    std::vector<uint8_t> stack;     // Copy of the target's stack from its Rsp upwards
+    size_t stackBytes = 0;
+    bool stackComplete = false;     // The copy reaches the top of the stack
+};
+
+namespace {
+    // Raw merged counters for one tag; converted to microseconds only when a snapshot is taken
+    struct TagTotals {
+        uint64_t sliceBuckets[TagStats::kSliceBuckets] = {};
+        uint64_t slices = 0;
+        uint64_t maxSliceTicks = 0;
+        uint64_t cpuTicks = 0;
+        uint64_t waitTicks[TagStats::kWaitKinds] = {};
+    };
+
+    struct WatchRegistry {
+        std::mutex mutex;
+        std::vector<Scheduler*> schedulers;
+        // Tables of schedulers that have already exited, so short-lived pool workers still show up
+        std::unordered_map<const TaskTag*, TagTotals> retired;
+    };
+
+    WatchRegistry& Registry() {
+        static WatchRegistry registry;
+        return registry;
+    }
+
+    double CalibrateTicks() {
+        LARGE_INTEGER frequency, qpcStart, qpcEnd;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&qpcStart);
+        uint64_t tscStart = ReadTicks();
+        Sleep(20);
+        QueryPerformanceCounter(&qpcEnd);
+        uint64_t tscEnd = ReadTicks();
+
+        double microseconds = (qpcEnd.QuadPart - qpcStart.QuadPart) * 1e6 / frequency.QuadPart;
+        return microseconds > 0 ? (tscEnd - tscStart) / microseconds : 1.0;
+    }
+
+    void MergeInto(std::unordered_map<const TaskTag*, TagTotals>& totals, const TaskTag* tag, const TagStats& stats) {
+        TagTotals& total = totals[tag];
+        for (size_t i = 0; i < TagStats::kSliceBuckets; ++i) {
+            uint64_t count = stats.sliceBuckets[i].load(std::memory_order_relaxed);
+            total.sliceBuckets[i] += count;
+            total.slices += count;
+        }
+        total.maxSliceTicks = std::max(total.maxSliceTicks, stats.maxSliceTicks.load(std::memory_order_relaxed));
+        total.cpuTicks += stats.cpuTicks.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < TagStats::kWaitKinds; ++i) {
+            total.waitTicks[i] += stats.waitTicks[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    std::unordered_map<const TaskTag*, TagTotals> MergeAllTagStats() {
+        WatchRegistry& registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        std::unordered_map<const TaskTag*, TagTotals> totals = registry.retired;
+        for (Scheduler* scheduler : registry.schedulers) {
+            scheduler->ForEachTagStats([&](const TaskTag* tag, const TagStats& stats) { MergeInto(totals, tag, stats); });
+        }
+        return totals;
+    }
+
+    const char* TagName(const TaskTag* tag) {
+        return tag ? tag->name : "untagged";
+    }
+
+    // Single writer: plain load/store keeps the switch path free of locked instructions
+    void AddRelaxed(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    void PrintHogReport(const HogReport& report) {
+        fprintf(stderr, "[HogWatchdog] Coroutine '%s' on thread %lu has run %.1f ms without yielding\n", report.tag, static_cast<unsigned long>(report.threadId), report.sliceMilliseconds);
+        for (size_t i = 0; i < report.frameCount; ++i) {
+            fprintf(stderr, "\t#%zu %p\n", i, report.frames[i]);
+        }
+    }
+}
+
+bool ShouldOffloadTag(const TaskTag& tag) {
+    return HogWatchdog::offloadHeavyTags.load(std::memory_order_relaxed) && tag.hogReports.load(std::memory_order_relaxed) >= HogWatchdog::heavyAfterReports.load(std::memory_order_relaxed);
+}
+
+HogWatchdog::HogWatchdog(WatchdogOptions opts) : options(std::move(opts)) {
+    if (active.exchange(true)) {
+        throw std::runtime_error("Only one HogWatchdog may be active at a time.");
+    }
+    if (!options.onHog) {
+        options.onHog = PrintHogReport;
+    }
+
+    sliceTicks = static_cast<uint64_t>(options.slice.count() * 1000.0 * TicksPerMicrosecond());
+    heavyAfterReports.store(std::max<uint32_t>(1, options.heavyAfterReports), std::memory_order_relaxed);
+    offloadHeavyTags.store(options.offloadHeavyTags, std::memory_order_relaxed);
+    monitor = std::thread(&HogWatchdog::MonitorLoop, this);
+
+    DebugPrint("[HogWatchdog::HogWatchdog] Watching with a %lld ms slice\n", static_cast<long long>(options.slice.count()));
+}
+
+HogWatchdog::~HogWatchdog() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopping = true;
+    }
+    stopCondition.notify_all();
+    monitor.join();
+
+    offloadHeavyTags.store(false, std::memory_order_relaxed);
+    active.store(false);
+}
+
+double HogWatchdog::TicksPerMicrosecond() {
+    static const double ticksPerMicrosecond = CalibrateTicks();
+    return ticksPerMicrosecond;
+}
+
+void HogWatchdog::RegisterScheduler(Scheduler* scheduler) {
+    WatchRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.schedulers.push_back(scheduler);
+}
+
+void HogWatchdog::UnregisterScheduler(Scheduler* scheduler) {
+    WatchRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.schedulers.erase(std::remove(registry.schedulers.begin(), registry.schedulers.end(), scheduler), registry.schedulers.end());
+
+    scheduler->ForEachTagStats([&](const TaskTag* tag, const TagStats& stats) { MergeInto(registry.retired, tag, stats); });
+}
+
+std::vector<TagSliceHistogram> HogWatchdog::SliceHistograms() {
+    std::vector<TagSliceHistogram> histograms;
+    for (const auto& entry : MergeAllTagStats()) {
+        const TagTotals& total = entry.second;
+        TagSliceHistogram histogram = {};
+        histogram.tag = TagName(entry.first);
+        std::copy(std::begin(total.sliceBuckets), std::end(total.sliceBuckets), histogram.buckets);
+        histogram.slices = total.slices;
+        histogram.maxSliceMicroseconds = total.maxSliceTicks / TicksPerMicrosecond();
+        histogram.hogReports = entry.first ? entry.first->hogReports.load(std::memory_order_relaxed) : 0;
+        histograms.push_back(histogram);
+    }
+    return histograms;
+}
+
+void TaskProfiler::Enable() {
+    // Calibrate up front so the first profiled switch does not pay for it
+    HogWatchdog::TicksPerMicrosecond();
+    enabled.store(true);
+}
+
+void TaskProfiler::Disable() {
+    enabled.store(false);
+}
+
+std::vector<TagProfile> TaskProfiler::Snapshot() {
+    const double ticksPerMicrosecond = HogWatchdog::TicksPerMicrosecond();
+    std::vector<TagProfile> profiles;
+    for (const auto& entry : MergeAllTagStats()) {
+        const TagTotals& total = entry.second;
+        TagProfile profile = {};
+        profile.tag = TagName(entry.first);
+        profile.slices = total.slices;
+        profile.cpuMicroseconds = total.cpuTicks / ticksPerMicrosecond;
+        for (size_t i = 0; i < TagStats::kWaitKinds; ++i) {
+            profile.waitMicroseconds[i] = total.waitTicks[i] / ticksPerMicrosecond;
+        }
+        profiles.push_back(profile);
+    }
+    std::sort(profiles.begin(), profiles.end(), [](const TagProfile& a, const TagProfile& b) { return a.cpuMicroseconds > b.cpuMicroseconds; });
+    return profiles;
+}
+
+void HogWatchdog::MonitorLoop() {
+    WatchRegistry& registry = Registry();
+    std::vector<Sample> samples;
+
+    std::unique_lock<std::mutex> lock(stopMutex);
+    while (!stopCondition.wait_for(lock, options.pollInterval, [this] { return stopping; })) {
+        lock.unlock();
+
+        size_t sampled = 0;
+        {
+            // Holding the registry lock keeps every inspected scheduler alive
+            std::lock_guard<std::mutex> registryLock(registry.mutex);
+            uint64_t now = ReadTicks();
+            for (Scheduler* scheduler : registry.schedulers) {
+                if (samples.size() == sampled) {
+                    samples.emplace_back();
+                }
+                bool found = false;
+                Inspect(scheduler, now, samples[sampled], found);
+                if (found) {
+                    ++sampled;
+                }
+            }
+        }
+        // The unwinder may take the loader lock, so it only runs once every target is running again
+        for (size_t i = 0; i < sampled; ++i) {
+            Unwind(samples[i]);
+            options.onHog(samples[i].report);
+        }
+
+        lock.lock();
+    }
+}
+
+void HogWatchdog::Inspect(Scheduler* scheduler, uint64_t now, Sample& sample, bool& found) {
+    Scheduler::RunSlot& slot = scheduler->runSlot;
+    if (!slot.running.load(std::memory_order_acquire)) {
+        return;
+    }
+    uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    uint64_t resumeTicks = slot.resumeTicks.load(std::memory_order_relaxed);
+    const TaskTag* tag = slot.tag.load(std::memory_order_relaxed);
+    if (sequence == slot.reportedSequence || now < resumeTicks || now - resumeTicks < sliceTicks) {
+        return;
+    }
+
+    HogReport& report = sample.report;
+    report.tag = TagName(tag);
+    report.threadId = scheduler->threadId;
+    report.sliceMilliseconds = (now - resumeTicks) / TicksPerMicrosecond() / 1000.0;
+    report.frameCount = 0;
+    sample.stackBytes = 0;
+    sample.stackComplete = false;
+
+    if (SuspendThread(scheduler->threadHandle) == static_cast<DWORD>(-1)) {
+        return;
+    }
+    // Only sample the stack if the offending slice is still the one running.
+    // The target may hold any lock here: take its registers and a raw copy of its stack, nothing else.
+    if (slot.running.load(std::memory_order_acquire) && slot.sequence.load(std::memory_order_acquire) == sequence) {
+#if defined(_M_X64) || defined(_M_AMD64)
+        sample.context = {};
+        sample.context.ContextFlags = CONTEXT_FULL;
+        if (GetThreadContext(scheduler->threadHandle, &sample.context)) {
+            MEMORY_BASIC_INFORMATION region;
+            if (VirtualQuery(reinterpret_cast<void*>(sample.context.Rsp), &region, sizeof(region)) && region.State == MEM_COMMIT) {
+                size_t available = reinterpret_cast<uintptr_t>(region.BaseAddress) + region.RegionSize - sample.context.Rsp;
+                sample.stackBytes = std::min(available, sample.stack.size());
+                sample.stackComplete = available <= sample.stack.size();
+                memcpy(sample.stack.data(), reinterpret_cast<void*>(sample.context.Rsp), sample.stackBytes);
+            }
+        } else {
+            sample.context.Rip = 0;
+        }
+#endif
+        found = true;
+    }
+    ResumeThread(scheduler->threadHandle);
+
+    if (found) {
+        slot.reportedSequence = sequence;
+        if (tag) {
+            tag->hogReports.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void HogWatchdog::Unwind(Sample& sample) {
+#if defined(_M_X64) || defined(_M_AMD64)
+    HogReport& report = sample.report;
+    CONTEXT& context = sample.context;
+    const DWORD64 liveLow = context.Rsp;
+    const DWORD64 liveHigh = liveLow + sample.stackBytes;
+    const DWORD64 copyLow = reinterpret_cast<DWORD64>(sample.stack.data());
+    const DWORD64 copyHigh = copyLow + sample.stackBytes;
+    const DWORD64 slack = sample.stackComplete ? sizeof(DWORD64) : Sample::kStackSlack;
+    // Registers that can hold stack addresses; saved values popped by the unwinder point at the live stack too
+    DWORD64* registers[] = {&context.Rsp, &context.Rbp, &context.Rbx, &context.Rsi, &context.Rdi, &context.R12, &context.R13, &context.R14, &context.R15};
+
+    // The thread has moved on, so walk the copy: rebase anything that points into the captured range
+    while (report.frameCount < HogReport::kMaxFrames && context.Rip) {
+        report.frames[report.frameCount++] = reinterpret_cast<void*>(context.Rip);
+        for (DWORD64* value : registers) {
+            if (*value >= liveLow && *value < liveHigh) {
+                *value = *value - liveLow + copyLow;
+            }
+        }
+        if (context.Rsp < copyLow || context.Rsp + slack > copyHigh) {
+            break;
+        }
+
+        DWORD64 imageBase = 0;
+        PRUNTIME_FUNCTION function = RtlLookupFunctionEntry(context.Rip, &imageBase, nullptr);
+        if (!function) {
+            // Leaf function without unwind data: the return address is on top of the stack
+            context.Rip = *reinterpret_cast<DWORD64*>(context.Rsp);
+            context.Rsp += sizeof(DWORD64);
+            continue;
+        }
+        PVOID handlerData = nullptr;
+        DWORD64 establisherFrame = 0;
+        RtlVirtualUnwind(UNW_FLAG_NHANDLER, imageBase, context.Rip, function, &context, &handlerData, &establisherFrame, nullptr);
+    }
+#else
+    (void)sample;
+#endif
+}
+
+TagStats* Scheduler::StatsForTag(const TaskTag* tag) {
+    // Only this thread inserts, so the lookup needs no lock; snapshots lock against the insert
+    auto it = tagStats.find(tag);
+    if (it != tagStats.end()) {
+        return it->second.get();
+    }
+    std::lock_guard<std::mutex> lock(tagStatsMutex);
+    return tagStats.emplace(tag, std::make_unique<TagStats>()).first->second.get();
+}
+
+void Scheduler::RecordSlice(Coroutine* co, uint64_t ticks) {
+    if (!co->stats) {
+        co->stats = StatsForTag(co->tag);
+    }
+    TagStats* stats = co->stats;
+
+    uint64_t microseconds = static_cast<uint64_t>(ticks / HogWatchdog::TicksPerMicrosecond());
+    size_t bucket = 0;
+    while (microseconds && bucket + 1 < TagStats::kSliceBuckets) {
+        microseconds >>= 1;
+        ++bucket;
+    }
+
+    AddRelaxed(stats->sliceBuckets[bucket], 1);
+    AddRelaxed(stats->cpuTicks, ticks);
+    if (ticks > stats->maxSliceTicks.load(std::memory_order_relaxed)) {
+        stats->maxSliceTicks.store(ticks, std::memory_order_relaxed);
+    }
+}
+
+void Scheduler::RecordWait(Coroutine* co, uint64_t resumeTicks) {
+    // Coroutines created before profiling was enabled have no start point for their first wait
+    if (co->waitStartTicks && resumeTicks > co->waitStartTicks) {
+        if (!co->stats) {
+            co->stats = StatsForTag(co->tag);
+        }
+        AddRelaxed(co->stats->waitTicks[static_cast<size_t>(co->waitKind)], resumeTicks - co->waitStartTicks);
+    }
+    co->waitKind = WaitKind::Ready;
+}
+
+void Scheduler::RecordPoolWait(const TaskTag* tag, std::chrono::steady_clock::duration wait) {
+    double microseconds = std::chrono::duration<double, std::micro>(wait).count();
+    AddRelaxed(StatsForTag(tag)->waitTicks[static_cast<size_t>(WaitKind::Pool)], static_cast<uint64_t>(microseconds * HogWatchdog::TicksPerMicrosecond()));
+}
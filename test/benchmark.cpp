@@ -12,6 +12,14 @@
 #include <mutex>
 #include <filesystem>
 #include <fstream>
+#include <algorithm>
+#include <iomanip>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <cstdarg>
+#include <cstdlib>
+#include <new>
 
 class TestRunner {
 public:
@@ -58,6 +66,25 @@ private:
     int failedCount = 0;
 };
 
+// Counts operator new calls so benchmarks can report allocations per operation
+static std::atomic<uint64_t> allocationCount{0};
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
 namespace TestCases {
 
 static void Foo() {
@@ -135,6 +162,20 @@ void ExceptionHandling() {
             throw;
         }
     }
+
+    // Slots of cleanly finished coroutines are reused: a later failure must still be reported, and only once
+    std::vector<std::shared_ptr<CoroutinePromise<void>>> clean;
+    for (int i = 0; i < 8; ++i) {
+        clean.push_back(scheduler.CreateCoroutine<void>([]() { Coroutine::YieldExecution(); }));
+    }
+    scheduler.Run();
+    auto failing = scheduler.CreateCoroutine<void>(ThrowingCoroutine);
+    auto passing = scheduler.CreateCoroutine<void>([]() {});
+    scheduler.Run();
+    assert(failing->HasException() && !passing->HasException());
+    for (const auto& done : clean) {
+        assert(done->IsCompleted() && !done->HasException());
+    }
 }
 
 void AsyncSleep() {
@@ -342,6 +383,1623 @@ void StdMutexDeadlockTest() {
     // The test passes because the deadlock is caught by the VEH...
 }
 
+static uint64_t ProcessCpuTime100ns() {
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+    auto toUint64 = [](const FILETIME& ft) {
+        return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    };
+    return toUint64(kernelTime) + toUint64(userTime);
+}
+
+void IdlePolicyLatencyBenchmark() {
+    const int rounds = 2000;
+    const std::pair<IdlePolicy, const char*> modes[] = {
+        {IdlePolicy::Block, "Block"},
+        {IdlePolicy::SpinThenPark, "SpinThenPark"},
+        {IdlePolicy::BusyPoll, "BusyPoll"},
+    };
+
+    for (const auto& [policy, name] : modes) {
+        Scheduler scheduler;
+        scheduler.SetIdlePolicy(policy, 100);
+        Scheduler::GetThreadPool().SetIdlePolicy(policy, 100);
+
+        std::vector<double> latencies;
+        latencies.reserve(rounds);
+
+        auto wallStart = std::chrono::steady_clock::now();
+        uint64_t cpuStart = ProcessCpuTime100ns();
+
+        scheduler.CreateCoroutine<void>([&]() {
+            IoOperation op;
+            op.coroutine = scheduler.GetRunningCoroutine();
+            for (int i = 0; i < rounds; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                // Ping goes through the pool queue, pong comes back through the IOCP
+                Scheduler::GetThreadPool().Submit([&scheduler, &op]() {
+                    scheduler.PostCompletion(&op);
+                });
+                Coroutine::SuspendExecution();
+                latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            }
+        });
+        scheduler.Run();
+
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        double cpuSeconds = (ProcessCpuTime100ns() - cpuStart) / 1e7;
+        Scheduler::GetThreadPool().SetIdlePolicy(IdlePolicy::Block);
+
+        std::sort(latencies.begin(), latencies.end());
+        double average = 0.0;
+        for (double latency : latencies) {
+            average += latency;
+        }
+        average /= latencies.size();
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "\t" << std::setw(13) << std::left << name << std::right
+                  << " round trip avg " << average << " us"
+                  << ", p50 " << latencies[latencies.size() / 2] << " us"
+                  << ", p99 " << latencies[latencies.size() * 99 / 100] << " us"
+                  << ", CPU " << (cpuSeconds / wallSeconds) * 100.0 << "% of one core" << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+        assert(latencies.size() == static_cast<size_t>(rounds));
+    }
+}
+
+void CoreScalingBenchmark() {
+    const size_t maxCores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const int messagesPerCore = 20000;
+    const int batchSize = 64;
+
+    for (size_t numCores = 1;; numCores = std::min(numCores * 2, maxCores)) {
+        CoreRuntime runtime(numCores);
+        std::vector<Task<int>> drivers;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t core = 0; core < numCores; ++core) {
+            drivers.push_back(runtime.SubmitTo<int>(core, [&runtime, core, numCores, messagesPerCore, batchSize]() {
+                // Each core streams small requests to its neighbour and waits for the replies
+                size_t neighbour = (core + 1) % numCores;
+                std::vector<Task<int>> inFlight;
+                inFlight.reserve(batchSize);
+                int replies = 0;
+                for (int sent = 0; sent < messagesPerCore; sent += batchSize) {
+                    for (int i = 0; i < batchSize; ++i) {
+                        inFlight.push_back(runtime.SubmitTo<int>(neighbour, [](int value) { return value + 1; }, i));
+                    }
+                    for (auto& reply : inFlight) {
+                        replies += Await(reply) > 0 ? 1 : 0;
+                    }
+                    inFlight.clear();
+                }
+                return replies;
+            }));
+        }
+
+        int totalReplies = 0;
+        for (auto& driver : drivers) {
+            totalReplies += Await(driver);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "\t" << std::setw(3) << numCores << " cores: "
+                  << static_cast<uint64_t>(totalReplies / seconds) << " cross-core round trips/s" << std::endl;
+        assert(totalReplies == static_cast<int>(numCores) * ((messagesPerCore + batchSize - 1) / batchSize) * batchSize);
+
+        if (numCores == maxCores) {
+            break;
+        }
+    }
+
+    // Stop runs everything already posted; posting afterwards fails instead of dropping the job
+    CoreRuntime runtime(2);
+    std::vector<Task<int>> late;
+    for (int i = 0; i < 1000; ++i) {
+        late.push_back(runtime.SubmitTo<int>(i % 2, [](int value) { return value; }, i));
+    }
+    runtime.Stop();
+    for (int i = 0; i < 1000; ++i) {
+        assert(late[i].GetPromise()->IsCompleted() && Await(late[i]) == i);
+    }
+    bool rejected = false;
+    try {
+        runtime.SubmitTo<int>(0, []() { return 0; });
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
+}
+
+static int SpinFor(std::chrono::microseconds duration) {
+    auto end = std::chrono::steady_clock::now() + duration;
+    int iterations = 0;
+    while (std::chrono::steady_clock::now() < end) {
+        ++iterations;
+    }
+    return iterations;
+}
+
+void ElasticThreadPoolBenchmark() {
+    const size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t numTasks = cores * 16;
+    Scheduler& pool = Scheduler::GetThreadPool();
+
+    auto runMixedWorkload = [&](bool hinted) {
+        Scheduler scheduler;
+        double seconds = 0.0;
+        scheduler.CreateCoroutine<void>([&]() {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<Task<int>> tasks;
+            for (size_t i = 0; i < numTasks; ++i) {
+                if (i % 4 == 0) {
+                    tasks.push_back(RunOnThreadPool<int>([hinted]() {
+                        auto blockingCall = []() {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                            return 1;
+                        };
+                        return hinted ? RunBlocking(blockingCall) : blockingCall();
+                    }));
+                } else {
+                    tasks.push_back(RunOnThreadPool<int>(SpinFor, std::chrono::microseconds(2000)));
+                }
+            }
+            for (auto& task : tasks) {
+                Await(task);
+            }
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        });
+        scheduler.Run();
+        return seconds;
+    };
+
+    pool.Configure(ThreadPoolOptions{cores, cores, 0});
+    double fixedSeconds = runMixedWorkload(false);
+    std::cout << "\tFixed pool (" << cores << " workers), no hint:        " << fixedSeconds * 1000.0 << " ms" << std::endl;
+
+    pool.Configure(ThreadPoolOptions{cores, cores * 4});
+    double elasticSeconds = runMixedWorkload(true);
+    std::cout << "\tElastic pool with RunBlocking hint (" << pool.WorkerCount() << " workers after run): " << elasticSeconds * 1000.0 << " ms" << std::endl;
+
+    const size_t queueBound = 32;
+    pool.Configure(ThreadPoolOptions{cores, cores, 0, queueBound});
+    {
+        Scheduler scheduler;
+        size_t peakQueue = 0;
+        int ticks = 0;
+        bool producing = true;
+
+        scheduler.CreateCoroutine<void>([&]() {
+            std::vector<Task<int>> tasks;
+            for (int i = 0; i < 5000; ++i) {
+                tasks.push_back(RunOnThreadPool<int>(SpinFor, std::chrono::microseconds(50)));
+                peakQueue = std::max(peakQueue, pool.PendingTasks());
+            }
+            for (auto& task : tasks) {
+                Await(task);
+            }
+            producing = false;
+        });
+        scheduler.CreateCoroutine<void>([&]() {
+            // Proves the event loop keeps running while the producer is held back
+            while (producing) {
+                ++ticks;
+                Coroutine::YieldExecution();
+            }
+        });
+        scheduler.Run();
+
+        std::cout << "\tBounded queue (" << queueBound << "): peak depth " << peakQueue << ", other coroutine ran " << ticks << " times" << std::endl;
+        assert(peakQueue <= queueBound);
+        assert(ticks > 0);
+    }
+
+    // A lone producer coroutine has no siblings to yield to; it parks until a worker frees a slot
+    {
+        Scheduler scheduler;
+        int completed = 0;
+        scheduler.CreateCoroutine<void>([&]() {
+            std::vector<Task<int>> tasks;
+            for (int i = 0; i < 2000; ++i) {
+                tasks.push_back(RunOnThreadPool<int>([]() { return 1; }));
+            }
+            for (auto& task : tasks) {
+                completed += Await(task);
+            }
+        });
+        scheduler.Run();
+        assert(completed == 2000);
+    }
+
+    // Lifting the bound releases a thread already waiting for space; a stopped pool rejects work
+    {
+        Scheduler bounded(ThreadPoolOptions{1, 1, 0, 1});
+        std::atomic<bool> release{false};
+        bounded.Submit([&]() {
+            while (!release) {
+                std::this_thread::yield();
+            }
+        });
+        while (bounded.PendingTasks() != 0) {
+            std::this_thread::yield();
+        }
+        bounded.Submit([]() {});
+
+        std::atomic<bool> submitted{false};
+        std::thread producer([&]() {
+            bounded.Submit([]() {});
+            submitted = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        bounded.Configure(ThreadPoolOptions{1, 1});
+        producer.join();
+        assert(submitted);
+        release = true;
+
+        bounded.Stop();
+        bool rejected = false;
+        try {
+            bounded.Submit([]() {});
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+
+    // With its only worker stuck in a long task nothing dequeues; the pool still grows for the next task
+    {
+        Scheduler growing(ThreadPoolOptions{1, 4, 64, 0, std::chrono::milliseconds(5)});
+        std::atomic<bool> release{false};
+        std::atomic<bool> ran{false};
+        growing.Submit([&]() {
+            while (!release) {
+                std::this_thread::yield();
+            }
+        });
+        while (growing.PendingTasks() != 0) {
+            std::this_thread::yield();
+        }
+        growing.Submit([&]() { ran = true; });
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (!ran && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::cout << "\tLong task holding the only worker: queued task ran " << (ran ? "on a grown worker" : "never") << ", " << growing.WorkerCount() << " workers" << std::endl;
+        assert(ran);
+        assert(growing.WorkerCount() >= 2);
+        release = true;
+    }
+
+    // A worker submitting to its own full queue runs the task itself instead of parking the only worker
+    {
+        Scheduler bounded(ThreadPoolOptions{1, 1, 0, 1});
+        std::atomic<int> ran{0};
+        std::atomic<int> done{0};
+        bounded.Submit([&]() {
+            for (int i = 0; i < 3; ++i) {
+                bounded.Submit([&]() { ++ran; }, nullptr, [&](std::shared_ptr<ExceptionState>) { ++done; });
+            }
+        });
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (done < 3 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        assert(ran == 3);
+        assert(done == 3);
+    }
+
+    pool.Configure(ThreadPoolOptions{});
+}
+
+template <typename Func>
+static double MeasureMilliseconds(Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ParallelAlgorithmsBenchmark() {
+    Scheduler& pool = Scheduler::GetThreadPool();
+    const size_t maxCores = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    auto runSuite = [](size_t n, bool printSerial) {
+        std::vector<double> values(n);
+        std::vector<uint32_t> keys(n);
+        std::mt19937 rng(1337);
+        for (auto& key : keys) {
+            key = rng();
+        }
+        std::vector<uint32_t> keysCopy = keys;
+
+        double serialFor = MeasureMilliseconds([&]() {
+            for (size_t i = 0; i < n; ++i) {
+                values[i] = std::sqrt(static_cast<double>(i));
+            }
+        });
+        double parallelFor = MeasureMilliseconds([&]() {
+            auto task = ParallelFor(size_t(0), n, [&values](size_t i) { values[i] = std::sqrt(static_cast<double>(i)); });
+            Await(task);
+        });
+
+        double serialSum = 0.0;
+        double serialReduce = MeasureMilliseconds([&]() {
+            for (size_t i = 0; i < n; ++i) {
+                serialSum += values[i];
+            }
+        });
+        double parallelSum = 0.0;
+        double parallelReduce = MeasureMilliseconds([&]() {
+            auto task = ParallelReduce(size_t(0), n, 0.0, [&values](size_t i) { return values[i]; }, std::plus<>());
+            parallelSum = Await(task);
+        });
+        assert(std::abs(serialSum - parallelSum) <= 1e-9 * std::abs(serialSum));
+
+        double serialSort = MeasureMilliseconds([&]() { std::sort(keysCopy.begin(), keysCopy.end()); });
+        double parallelSort = MeasureMilliseconds([&]() {
+            auto task = ParallelSort(keys.begin(), keys.end());
+            Await(task);
+        });
+        assert(std::is_sorted(keys.begin(), keys.end()));
+        assert(keys == keysCopy);
+
+        std::cout << std::fixed << std::setprecision(2);
+        if (printSerial) {
+            std::cout << "\t  serial:   for " << serialFor << " ms, reduce " << serialReduce << " ms, sort " << serialSort << " ms" << std::endl;
+        }
+        std::cout << "\t  parallel: for " << parallelFor << " ms, reduce " << parallelReduce << " ms, sort " << parallelSort << " ms" << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    };
+
+    for (size_t n : {size_t(100000), size_t(1000000), size_t(8000000)}) {
+        std::cout << "\t" << n << " elements, " << maxCores << " workers" << std::endl;
+        runSuite(n, true);
+    }
+
+    for (size_t cores = 1;; cores = std::min(cores * 2, maxCores)) {
+        pool.Configure(ThreadPoolOptions{cores, cores});
+        std::cout << "\t8000000 elements, " << cores << " workers" << std::endl;
+        runSuite(8000000, cores == 1);
+        if (cores == maxCores) {
+            break;
+        }
+    }
+    pool.Configure(ThreadPoolOptions{});
+
+    // The awaiting coroutine yields, so its siblings keep running during the parallel loop
+    Scheduler scheduler;
+    bool running = true;
+    int ticks = 0;
+    scheduler.CreateCoroutine<void>([&]() {
+        std::vector<double> values(4000000);
+        auto task = ParallelFor(size_t(0), values.size(), [&values](size_t i) { values[i] = std::sqrt(static_cast<double>(i)); });
+        Await(task);
+        running = false;
+    });
+    scheduler.CreateCoroutine<void>([&]() {
+        while (running) {
+            ++ticks;
+            Coroutine::YieldExecution();
+        }
+    });
+    scheduler.Run();
+    std::cout << "\tSibling coroutine ran " << ticks << " times while ParallelFor was in flight" << std::endl;
+    assert(ticks > 0);
+
+    // A throwing body fails the whole call instead of leaving the awaiter hanging
+    std::atomic<int> inFlight{0};
+    auto failedFor = ParallelFor(0, 100000, [&inFlight](int i) {
+        ++inFlight;
+        if (i == 4242) {
+            throw std::runtime_error("ParallelFor body failed");
+        }
+        --inFlight;
+    }, 64);
+    bool forFailed = false;
+    try {
+        Await(failedFor);
+    } catch (const std::runtime_error&) {
+        forFailed = true;
+    }
+    // Only the abandoned iteration is still counted: no sibling chunk outlives the failed call
+    assert(inFlight == 1);
+
+    // The accumulator needs no default constructor; the identity seeds it
+    struct Tally {
+        explicit Tally(int v) : value(v) {}
+        int value;
+    };
+    auto tallyAdd = [](Tally a, Tally b) { return Tally(a.value + b.value); };
+    auto tally = ParallelReduce(0, 100000, Tally(0), [](int) { return Tally(1); }, tallyAdd, 64);
+    assert(Await(tally).value == 100000);
+
+    auto failedReduce = ParallelReduce(0, 100000, Tally(0), [](int i) {
+        if (i == 777) {
+            throw std::runtime_error("ParallelReduce map failed");
+        }
+        return Tally(1);
+    }, tallyAdd, 64);
+    bool reduceFailed = false;
+    try {
+        Await(failedReduce);
+    } catch (const std::runtime_error&) {
+        reduceFailed = true;
+    }
+    assert(forFailed && reduceFailed);
+    std::cout << "\tThrowing bodies rethrown from ParallelFor and ParallelReduce" << std::endl;
+}
+
+void ContinuationChainBenchmark() {
+    for (int depth : {1, 10, 100, 1000}) {
+        Scheduler scheduler;
+        double thenMs = 0.0;
+        double coroutineMs = 0.0;
+
+        scheduler.CreateCoroutine<void>([&]() {
+            thenMs = MeasureMilliseconds([&]() {
+                auto root = std::make_shared<CoroutinePromise<int>>();
+                Task<int> tail(root);
+                for (int i = 0; i < depth; ++i) {
+                    tail = tail.Then([](int value) { return value + 1; });
+                }
+                root->SetResult(0);
+                int result = Await(tail);
+                assert(result == depth);
+            });
+
+            coroutineMs = MeasureMilliseconds([&]() {
+                Task<int> tail = CreateTask<int>([]() { return 0; });
+                for (int i = 0; i < depth; ++i) {
+                    tail = CreateTask<int>([previous = tail]() mutable { return Await(previous) + 1; });
+                }
+                int result = Await(tail);
+                assert(result == depth);
+            });
+        });
+        scheduler.Run();
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "\tDepth " << std::setw(4) << depth
+                  << ": Then " << thenMs * 1e6 / depth << " ns/step"
+                  << ", coroutine per step " << coroutineMs * 1e6 / depth << " ns/step" << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+
+    Scheduler scheduler;
+    bool continuationChecked = false;
+    scheduler.CreateCoroutine<void>([&]() {
+        // Pool result continued on this scheduler, then a nested pool task flattened with Unwrap
+        auto doubled = RunOnThreadPool<int>([]() { return 21; }).Then(scheduler, [](int value) { return value * 2; });
+        int doubledValue = Await(doubled);
+        assert(doubledValue == 42);
+
+        auto nested = doubled.Then([](int value) { return RunOnThreadPool<int>([value]() { return value + 1; }); }).Unwrap();
+        int nestedValue = Await(nested);
+        assert(nestedValue == 43);
+
+        auto observed = CreateTask<void>(ThrowingCoroutine).ContinueWith([](Task<void> task) { return task.GetPromise()->HasException(); });
+        bool sawException = Await(observed);
+        assert(sawException);
+        std::cout << "\tThen(scheduler), Unwrap and ContinueWith delivered the expected results" << std::endl;
+
+        // A throwing continuation fails its own task, not the coroutine that completed the antecedent
+        auto antecedent = CreateTask<int>([]() { return 1; });
+        auto failing = antecedent.Then([](int) -> int { throw std::runtime_error("continuation failed"); });
+        // Await would rethrow into the VEH and abandon this coroutine, so only wait for completion here
+        while (!failing.GetPromise()->IsCompleted()) {
+            Coroutine::YieldExecution();
+        }
+        assert(failing.GetPromise()->HasException());
+        assert(antecedent.GetPromise()->IsCompleted() && !antecedent.GetPromise()->HasException());
+        continuationChecked = true;
+    });
+    scheduler.Run();
+    assert(continuationChecked);
+
+    bool poolRejected = false;
+    try {
+        auto root = std::make_shared<CoroutinePromise<int>>();
+        Task<int>(root).Then(Scheduler::GetThreadPool(), [](int value) { return value; });
+    } catch (const std::runtime_error&) {
+        poolRejected = true;
+    }
+    assert(poolRejected);
+
+    // The target is destroyed before the antecedent completes: the continuation fails instead of reaching it
+    std::shared_ptr<CoroutinePromise<int>> lateRoot = std::make_shared<CoroutinePromise<int>>();
+    Task<int> late(lateRoot);
+    std::thread([&]() {
+        Scheduler shortLived;
+        late = Task<int>(lateRoot).Then(shortLived, [](int value) { return value; });
+    }).join();
+    lateRoot->SetResult(1);
+    assert(late.GetPromise()->IsCompleted() && late.GetPromise()->HasException());
+
+    // A continuation posted to a scheduler that never runs again fails once that scheduler is destroyed
+    std::atomic<Scheduler*> idleScheduler{nullptr};
+    std::atomic<bool> release{false};
+    std::thread owner([&]() {
+        Scheduler other;
+        idleScheduler = &other;
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+    while (!idleScheduler) {
+        std::this_thread::yield();
+    }
+    auto root = std::make_shared<CoroutinePromise<int>>();
+    auto orphan = Task<int>(root).Then(*idleScheduler, [](int value) { return value; });
+    root->SetResult(1);
+    release = true;
+    owner.join();
+    assert(orphan.GetPromise()->IsCompleted() && orphan.GetPromise()->HasException());
+    std::cout << "\tThrowing and orphaned continuations failed their own tasks" << std::endl;
+}
+
+void GeneratorBenchmark() {
+    for (uint64_t n : {uint64_t(1000000), uint64_t(10000000)}) {
+        uint64_t expected = 3 * (n * (n - 1) / 2);
+        uint64_t vectorSum = 0;
+        uint64_t generatorSum = 0;
+
+        double vectorMs = MeasureMilliseconds([&]() {
+            Scheduler scheduler;
+            auto promise = scheduler.CreateCoroutine<std::vector<uint64_t>>([n]() {
+                std::vector<uint64_t> records;
+                for (uint64_t i = 0; i < n; ++i) {
+                    records.push_back(i * 3);
+                }
+                return records;
+            });
+            scheduler.Run();
+            for (uint64_t record : promise->GetResult()) {
+                vectorSum += record;
+            }
+        });
+
+        double generatorMs = MeasureMilliseconds([&]() {
+            Generator<uint64_t> records([n](Generator<uint64_t>::Yielder& yielder) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    uint64_t record = i * 3;
+                    if (!yielder.Yield(record)) {
+                        return;
+                    }
+                }
+            });
+            for (uint64_t record : records) {
+                generatorSum += record;
+            }
+        });
+
+        assert(vectorSum == expected && generatorSum == expected);
+        std::cout << "\t" << n << " items: vector materialize " << static_cast<uint64_t>(n / (vectorMs / 1000.0)) << " items/s"
+                  << ", Generator " << static_cast<uint64_t>(n / (generatorMs / 1000.0)) << " items/s" << std::endl;
+    }
+
+    // Breaking out early resumes the producer once so its destructors run
+    int liveGuards = 0;
+    {
+        struct Guard {
+            int& live;
+            explicit Guard(int& l) : live(l) { ++live; }
+            ~Guard() { --live; }
+        };
+        Generator<int> numbers([&liveGuards](Generator<int>::Yielder& yielder) {
+            Guard guard(liveGuards);
+            for (int i = 0;; ++i) {
+                if (!yielder.Yield(i)) {
+                    return;
+                }
+            }
+        });
+        for (int value : numbers) {
+            if (value == 5) {
+                break;
+            }
+        }
+        assert(liveGuards == 1);
+    }
+    assert(liveGuards == 0);
+    std::cout << "\tEarly break cleaned up the producer" << std::endl;
+
+    // A producer that ignores Yield's result is abandoned instead of spinning in the destructor
+    {
+        Generator<int> endless([](Generator<int>::Yielder& yielder) {
+            for (int i = 0;; ++i) {
+                yielder.Yield(i);
+            }
+        });
+        for (int value : endless) {
+            if (value == 3) {
+                break;
+            }
+        }
+    }
+
+    // Destroying the generator that converted this thread keeps the fiber alive for the others
+    {
+        auto counter = [](Generator<int>::Yielder& yielder) {
+            for (int i = 0; i < 10; ++i) {
+                if (!yielder.Yield(i)) {
+                    return;
+                }
+            }
+        };
+        auto first = std::make_unique<Generator<int>>(counter);
+        Generator<int> second(counter);
+        assert(first->Next() && second.Next());
+        first.reset();
+        int seen = 1;
+        while (second.Next()) {
+            ++seen;
+        }
+        assert(seen == 10);
+    }
+
+    // A throwing producer ends the sequence and its exception surfaces from Next
+    auto failingProducer = [](Generator<int>::Yielder& yielder) {
+        yielder.Yield(1);
+        yielder.Yield(2);
+        throw std::runtime_error("producer failed");
+    };
+    {
+        Generator<int> failing(failingProducer);
+        int seen = 0;
+        bool producerFailed = false;
+        try {
+            for (int value : failing) {
+                seen += value;
+            }
+        } catch (const std::runtime_error&) {
+            producerFailed = true;
+        }
+        assert(producerFailed && seen == 3 && !failing.Next());
+    }
+    {
+        // Inside a coroutine the failure is charged to the consumer, and the scheduler keeps going
+        Scheduler scheduler;
+        auto consumer = scheduler.CreateCoroutine<int>([&failingProducer]() {
+            Generator<int> failing(failingProducer);
+            int seen = 0;
+            for (int value : failing) {
+                seen += value;
+            }
+            return seen;
+        });
+        auto sibling = scheduler.CreateCoroutine<int>([]() {
+            Coroutine::YieldExecution();
+            return 7;
+        });
+        scheduler.Run();
+        assert(consumer->IsCompleted() && consumer->HasException());
+        assert(sibling->GetResult() == 7);
+    }
+
+    Scheduler scheduler;
+    scheduler.CreateCoroutine<void>([]() {
+        const int count = 100000;
+        AsyncStream<int> stream([count](AsyncStream<int>::Yielder& yielder) {
+            for (int i = 0; i < count; ++i) {
+                if (i % 25000 == 0) {
+                    Scheduler::AsyncSleep(1);
+                }
+                if (!yielder.Yield(i)) {
+                    return;
+                }
+            }
+        });
+
+        int64_t sum = 0;
+        double ms = MeasureMilliseconds([&]() {
+            for (int value : stream) {
+                sum += value;
+            }
+        });
+        assert(sum == static_cast<int64_t>(count) * (count - 1) / 2);
+        std::cout << "\tAsyncStream with sleeping producer: " << static_cast<uint64_t>(count / (ms / 1000.0)) << " items/s" << std::endl;
+
+        // Dropping the stream wakes the parked producer so it can return
+        bool producerReturned = false;
+        auto watcher = CreateTask<void>([&producerReturned]() {
+            AsyncStream<int> numbers([&producerReturned](AsyncStream<int>::Yielder& yielder) {
+                for (int i = 0; yielder.Yield(i); ++i) {
+                }
+                producerReturned = true;
+            });
+            for (int value : numbers) {
+                if (value == 10) {
+                    break;
+                }
+            }
+        });
+        Await(watcher);
+        for (int i = 0; i < 10 && !producerReturned; ++i) {
+            Coroutine::YieldExecution();
+        }
+        assert(producerReturned);
+    });
+    scheduler.Run();
+}
+
+void PipelinedFileReadBenchmark() {
+    // Point WINASYNC_SCAN_FILE at a multi-GB file for a meaningful disk measurement
+    char configuredPath[MAX_PATH] = {0};
+    std::filesystem::path scanPath;
+    bool generated = false;
+    if (GetEnvironmentVariableA("WINASYNC_SCAN_FILE", configuredPath, MAX_PATH) > 0) {
+        scanPath = configuredPath;
+    } else {
+        scanPath = "scan_test.bin";
+        generated = true;
+        std::vector<char> block(1 << 20);
+        for (size_t i = 0; i < block.size(); ++i) {
+            block[i] = static_cast<char>(i * 31);
+        }
+        std::ofstream outFile(scanPath, std::ios::binary);
+        for (int i = 0; i < 256; ++i) {
+            outFile.write(block.data(), block.size());
+        }
+    }
+    const uint64_t expectedSize = std::filesystem::file_size(scanPath);
+    std::cout << "\tScanning " << scanPath.string() << " (" << expectedSize / (1 << 20) << " MiB)" << std::endl;
+
+    for (bool unbuffered : {false, true}) {
+        for (size_t chunkSize : {size_t(64) << 10, size_t(1) << 20}) {
+            for (size_t readahead : {size_t(1), size_t(4), size_t(16)}) {
+                Scheduler scheduler;
+                uint64_t bytesSeen = 0;
+                uint64_t checksum = 0;
+                double seconds = 0.0;
+
+                scheduler.CreateCoroutine<void>([&]() {
+                    FileReaderOptions options;
+                    options.chunkSize = chunkSize;
+                    options.readahead = readahead;
+                    options.maxBufferedChunks = readahead * 2;
+                    options.unbuffered = unbuffered;
+
+                    auto start = std::chrono::steady_clock::now();
+                    AsyncFileReader reader(scanPath.wstring(), options);
+                    AsyncFileReader::Chunk chunk;
+                    while (reader.Next(chunk)) {
+                        // Light per-chunk processing that overlaps with the reads still in flight
+                        for (size_t i = 0; i + sizeof(uint64_t) <= chunk.size; i += 64) {
+                            uint64_t word;
+                            std::memcpy(&word, chunk.data + i, sizeof(word));
+                            checksum += word;
+                        }
+                        bytesSeen += chunk.size;
+                    }
+                    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                });
+                scheduler.Run();
+
+                assert(bytesSeen == expectedSize);
+                std::cout << std::fixed << std::setprecision(2)
+                          << "\t" << (unbuffered ? "unbuffered" : "buffered  ")
+                          << " chunk " << std::setw(4) << chunkSize / 1024 << " KiB"
+                          << " readahead " << std::setw(2) << readahead
+                          << ": " << (bytesSeen / seconds) / 1e9 << " GB/s (checksum " << checksum % 1000 << ")" << std::endl;
+                std::cout.unsetf(std::ios::floatfield);
+            }
+        }
+    }
+
+    if (generated) {
+        std::filesystem::remove(scanPath);
+    }
+}
+
+void PolicySchedulerBenchmark() {
+    const int kSwitches = 1000000;
+    const int kSpawns = 100000;
+
+    auto measureSwitches = [&](auto runSchedulerWith) {
+        int counter = 0;
+        double ms = MeasureMilliseconds([&]() { runSchedulerWith(counter); });
+        assert(counter == kSwitches * 2);
+        return ms * 1e6 / (kSwitches * 2);
+    };
+
+    double generalSwitchNs = measureSwitches([&](int& counter) {
+        Scheduler scheduler;
+        for (int i = 0; i < 2; ++i) {
+            scheduler.CreateCoroutine<void>([&]() {
+                for (int n = 0; n < kSwitches; ++n) {
+                    ++counter;
+                    Coroutine::YieldExecution();
+                }
+            });
+        }
+        scheduler.Run();
+    });
+    double singleSwitchNs = measureSwitches([&](int& counter) {
+        SingleThreadScheduler scheduler;
+        for (int i = 0; i < 2; ++i) {
+            scheduler.Spawn([&]() {
+                for (int n = 0; n < kSwitches; ++n) {
+                    ++counter;
+                    SingleThreadScheduler::YieldExecution();
+                }
+            });
+        }
+        scheduler.Run();
+    });
+    double defaultSwitchNs = measureSwitches([&](int& counter) {
+        DefaultBasicScheduler scheduler;
+        for (int i = 0; i < 2; ++i) {
+            scheduler.Spawn([&]() {
+                for (int n = 0; n < kSwitches; ++n) {
+                    ++counter;
+                    DefaultBasicScheduler::YieldExecution();
+                }
+            });
+        }
+        scheduler.Run();
+    });
+
+    auto measureSpawns = [&](auto runSchedulerWith) {
+        int counter = 0;
+        double ms = MeasureMilliseconds([&]() { runSchedulerWith(counter); });
+        assert(counter == kSpawns);
+        return ms * 1e6 / kSpawns;
+    };
+
+    double generalSpawnNs = measureSpawns([&](int& counter) {
+        Scheduler scheduler;
+        for (int i = 0; i < kSpawns; ++i) {
+            scheduler.CreateCoroutine<void>([&]() { ++counter; });
+        }
+        scheduler.Run();
+    });
+    double singleSpawnNs = measureSpawns([&](int& counter) {
+        SingleThreadScheduler scheduler;
+        for (int i = 0; i < kSpawns; ++i) {
+            scheduler.Spawn([&]() { ++counter; });
+        }
+        scheduler.Run();
+    });
+    double defaultSpawnNs = measureSpawns([&](int& counter) {
+        DefaultBasicScheduler scheduler;
+        for (int i = 0; i < kSpawns; ++i) {
+            scheduler.Spawn([&]() { ++counter; });
+        }
+        scheduler.Run();
+    });
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "\tSwitch: Scheduler " << generalSwitchNs << " ns, SingleThreadScheduler " << singleSwitchNs
+              << " ns, DefaultBasicScheduler " << defaultSwitchNs << " ns" << std::endl
+              << "\tSpawn+run: Scheduler " << generalSpawnNs << " ns, SingleThreadScheduler " << singleSpawnNs
+              << " ns, DefaultBasicScheduler " << defaultSpawnNs << " ns" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+
+    // Timers, cross-thread Post and exception propagation on the full policy set
+    DefaultBasicScheduler scheduler;
+    std::atomic<int> posted{0};
+    bool slept = false;
+    scheduler.Spawn([&]() {
+        auto start = std::chrono::steady_clock::now();
+        DefaultBasicScheduler::AsyncSleep(20);
+        slept = std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20);
+    });
+    std::thread poster([&]() { scheduler.Post([&]() { posted.fetch_add(1); }); });
+    scheduler.Run();
+    poster.join();
+    if (posted.load() == 0) {
+        scheduler.Run();
+    }
+    assert(slept && posted.load() == 1);
+
+    // A Post wakes a loop whose only task is asleep instead of waiting out the timer
+    double postedAfterMs = 0.0;
+    auto sleepStart = std::chrono::steady_clock::now();
+    scheduler.Spawn([]() { DefaultBasicScheduler::AsyncSleep(300); });
+    std::thread latePoster([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        scheduler.Post([&]() { postedAfterMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sleepStart).count(); });
+    });
+    scheduler.Run();
+    latePoster.join();
+    assert(postedAfterMs > 0.0 && postedAfterMs < 200.0);
+
+    // A failure drops the tasks still pending, so a later Run starts clean
+    bool caught = false;
+    int survivors = 0;
+    scheduler.Spawn([]() { throw std::runtime_error("policy scheduler failure"); });
+    for (int i = 0; i < 100; ++i) {
+        scheduler.Spawn([&survivors]() {
+            DefaultBasicScheduler::YieldExecution();
+            ++survivors;
+        });
+    }
+    try {
+        scheduler.Run();
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    assert(caught && survivors == 0);
+    int after = 0;
+    scheduler.Spawn([&after]() { ++after; });
+    scheduler.Run();
+    assert(after == 1 && survivors == 0);
+    std::cout << "\tAsyncSleep, Post and exception rethrow behaved as expected" << std::endl;
+}
+
+void HogWatchdogBenchmark() {
+    static const TaskTag kYieldTag{"yield-loop"};
+    static const TaskTag kHogTag{"hog"};
+    const int kSwitches = 1000000;
+
+    auto measureSwitchNs = [&]() {
+        Scheduler scheduler;
+        for (int i = 0; i < 2; ++i) {
+            scheduler.CreateCoroutine<void>(kYieldTag, [&]() {
+                for (int n = 0; n < kSwitches; ++n) {
+                    Coroutine::YieldExecution();
+                }
+            });
+        }
+        double ms = MeasureMilliseconds([&]() { scheduler.Run(); });
+        return ms * 1e6 / (kSwitches * 2);
+    };
+
+    double unwatchedNs = measureSwitchNs();
+    std::mutex reportMutex;
+    std::vector<std::string> hogTags;
+    size_t deepestStack = 0;
+    double watchedNs = 0.0;
+    {
+        WatchdogOptions options;
+        options.slice = std::chrono::milliseconds(50);
+        options.onHog = [&](const HogReport& report) {
+            std::lock_guard<std::mutex> lock(reportMutex);
+            hogTags.push_back(report.tag);
+            deepestStack = std::max(deepestStack, report.frameCount);
+        };
+        HogWatchdog watchdog(options);
+        watchedNs = measureSwitchNs();
+
+        Scheduler scheduler;
+        scheduler.CreateCoroutine<int>(kHogTag, SpinFor, std::chrono::microseconds(200000));
+        scheduler.CreateCoroutine<void>([]() { Coroutine::YieldExecution(); });
+        scheduler.Run();
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "\tSwitch cost: " << unwatchedNs << " ns without watchdog, " << watchedNs << " ns with watchdog" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+
+    assert(!hogTags.empty() && hogTags.front() == "hog");
+    std::cout << "\tFlagged '" << hogTags.front() << "' with " << deepestStack << " captured frames" << std::endl;
+
+    for (const TagSliceHistogram& histogram : HogWatchdog::SliceHistograms()) {
+        std::cout << "\t" << std::setw(12) << histogram.tag << ": " << histogram.slices << " slices, max "
+                  << static_cast<uint64_t>(histogram.maxSliceMicroseconds) << " us, " << histogram.hogReports << " hog reports, buckets";
+        for (size_t i = 0; i < TagStats::kSliceBuckets; ++i) {
+            if (histogram.buckets[i]) {
+                std::cout << " <" << (uint64_t(1) << i) << "us:" << histogram.buckets[i];
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    // A tag with a hog report is now known-heavy, so debug offloading moves its body to the pool
+    WatchdogOptions offloadOptions;
+    offloadOptions.offloadHeavyTags = true;
+    offloadOptions.heavyAfterReports = 1;
+    HogWatchdog offloadingWatchdog(offloadOptions);
+
+    Scheduler scheduler;
+    DWORD schedulerThread = GetCurrentThreadId();
+    auto ranOn = scheduler.CreateCoroutine<DWORD>(kHogTag, []() { return GetCurrentThreadId(); });
+    scheduler.Run();
+    assert(ranOn->GetResult() != schedulerThread);
+    std::cout << "\tKnown-heavy tag was offloaded to a pool worker" << std::endl;
+}
+
+void TaskAccountingBenchmark() {
+    static const TaskTag kComputeTag{"compute"};
+    static const TaskTag kSleepTag{"sleeper"};
+    static const TaskTag kIoTag{"io-wait"};
+    static const TaskTag kPoolTag{"pool-work"};
+    static const TaskTag kSwitchTag{"switch-loop"};
+    const int kSwitches = 1000000;
+
+    auto measureSwitchNs = [&]() {
+        Scheduler scheduler;
+        for (int i = 0; i < 2; ++i) {
+            scheduler.CreateCoroutine<void>(kSwitchTag, [&]() {
+                for (int n = 0; n < kSwitches; ++n) {
+                    Coroutine::YieldExecution();
+                }
+            });
+        }
+        double ms = MeasureMilliseconds([&]() { scheduler.Run(); });
+        return ms * 1e6 / (kSwitches * 2);
+    };
+
+    double plainNs = measureSwitchNs();
+    TaskProfiler::Enable();
+    double profiledNs = measureSwitchNs();
+
+    Scheduler scheduler;
+    scheduler.CreateCoroutine<void>(kComputeTag, []() {
+        for (int i = 0; i < 20; ++i) {
+            SpinFor(std::chrono::microseconds(2000));
+            Coroutine::YieldExecution();
+        }
+    });
+    scheduler.CreateCoroutine<void>(kSleepTag, []() {
+        for (int i = 0; i < 10; ++i) {
+            Scheduler::AsyncSleep(5);
+        }
+    });
+    scheduler.CreateCoroutine<void>(kIoTag, [&scheduler]() {
+        IoOperation op;
+        op.coroutine = scheduler.GetRunningCoroutine();
+        for (int i = 0; i < 10; ++i) {
+            Scheduler::GetThreadPool().Submit([&scheduler, &op]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                scheduler.PostCompletion(&op);
+            });
+            Coroutine::SuspendExecution();
+        }
+    });
+    scheduler.CreateCoroutine<void>([]() {
+        std::vector<Task<int>> tasks;
+        for (int i = 0; i < 64; ++i) {
+            tasks.push_back(RunOnThreadPool<int>(kPoolTag, SpinFor, std::chrono::microseconds(1000)));
+        }
+        for (auto& task : tasks) {
+            Await(task);
+        }
+    });
+    scheduler.Run();
+    TaskProfiler::Disable();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "\tSwitch cost: " << plainNs << " ns unprofiled, " << profiledNs << " ns profiled" << std::endl
+              << "\t" << std::setw(12) << "tag" << std::setw(10) << "resumes" << std::setw(10) << "cpu ms"
+              << std::setw(10) << "ready ms" << std::setw(10) << "timer ms" << std::setw(10) << "io ms" << std::setw(10) << "pool ms" << std::endl;
+    const TagProfile* compute = nullptr;
+    const TagProfile* sleeper = nullptr;
+    const TagProfile* io = nullptr;
+    const TagProfile* pool = nullptr;
+    auto profiles = TaskProfiler::Snapshot();
+    for (const TagProfile& profile : profiles) {
+        std::cout << "\t" << std::setw(12) << profile.tag << std::setw(10) << profile.slices << std::setw(10) << profile.cpuMicroseconds / 1000.0
+                  << std::setw(10) << profile.Wait(WaitKind::Ready) / 1000.0 << std::setw(10) << profile.Wait(WaitKind::Timer) / 1000.0
+                  << std::setw(10) << profile.Wait(WaitKind::Io) / 1000.0 << std::setw(10) << profile.Wait(WaitKind::Pool) / 1000.0 << std::endl;
+        std::string tag = profile.tag;
+        if (tag == "compute") compute = &profile;
+        if (tag == "sleeper") sleeper = &profile;
+        if (tag == "io-wait") io = &profile;
+        if (tag == "pool-work") pool = &profile;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+
+    assert(compute && compute->cpuMicroseconds >= 30000);
+    assert(sleeper && sleeper->Wait(WaitKind::Timer) >= 40000);
+    assert(io && io->Wait(WaitKind::Io) >= 40000);
+    assert(pool && pool->cpuMicroseconds >= 50000);
+}
+
+static void SyncLogLine(FILE* out, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vfprintf(out, format, args);
+    va_end(args);
+    fflush(out);
+}
+
+void LoggingBenchmark() {
+    // The formatter reproduces printf output for the conversions the library uses
+    FILE* capture = std::tmpfile();
+    AsyncLogger::SetSink(capture);
+    const char* name = "scheduler";
+    LOG_ERROR("check %d %5.2f %s %zu %x %c%%\n", -42, 3.14159, name, size_t(7), 255u, 'z');
+    AsyncLogger::Flush();
+    std::rewind(capture);
+    char line[256] = {0};
+    std::fgets(line, sizeof(line), capture);
+    assert(std::strstr(line, "ERROR] check -42  3.14 scheduler 7 ff z%") != nullptr);
+
+    // A first record inside the VEH is dropped rather than allocating a ring; outside it, the ring is created
+    uint64_t droppedBeforeHandler = AsyncLogger::DroppedRecords();
+    std::thread([]() {
+        LogEnterExceptionHandler();
+        LOG_ERROR("inside handler %d\n", 1);
+        LogLeaveExceptionHandler();
+        LOG_ERROR("after handler %d\n", 2);
+    }).join();
+    assert(AsyncLogger::DroppedRecords() == droppedBeforeHandler + 1);
+    AsyncLogger::Flush();
+    AsyncLogger::SetSink(stdout);
+    std::fclose(capture);
+
+    FILE* nul = std::fopen("NUL", "w");
+    const int kCalls = 200000;
+
+    double syncMs = MeasureMilliseconds([&]() {
+        for (int i = 0; i < kCalls; ++i) {
+            SyncLogLine(nul, "[Scheduler::Run] Resuming coroutine %p in state %d value %.3f\n", static_cast<void*>(&i), i & 3, i * 0.5);
+        }
+    });
+
+    AsyncLogger::SetSink(nul);
+    uint64_t droppedBefore = AsyncLogger::DroppedRecords();
+    double asyncMs = MeasureMilliseconds([&]() {
+        for (int i = 0; i < kCalls; ++i) {
+            LOG_INFO("[Scheduler::Run] Resuming coroutine %p in state %d value %.3f\n", static_cast<void*>(&i), i & 3, i * 0.5);
+        }
+    });
+    double drainMs = MeasureMilliseconds([]() { AsyncLogger::Flush(); });
+
+    // Several producers at once, as with pool workers logging alongside the event loop
+    const int kThreads = 4;
+    double parallelMs = MeasureMilliseconds([&]() {
+        std::vector<std::thread> producers;
+        for (int t = 0; t < kThreads; ++t) {
+            producers.emplace_back([&]() {
+                for (int i = 0; i < kCalls / kThreads; ++i) {
+                    LOG_INFO("[Worker] task %d done in %llu ticks\n", i, static_cast<unsigned long long>(i) * 3);
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+    });
+    AsyncLogger::Flush();
+    uint64_t dropped = AsyncLogger::DroppedRecords() - droppedBefore;
+    AsyncLogger::SetSink(stdout);
+    std::fclose(nul);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "\tvfprintf+fflush: " << syncMs * 1e6 / kCalls << " ns/call" << std::endl
+              << "\tAsync logger:    " << asyncMs * 1e6 / kCalls << " ns/call on the caller (drain " << drainMs << " ms), "
+              << parallelMs * 1e6 / kCalls << " ns/call with " << kThreads << " producers, " << dropped << " dropped" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+// Zipf(s) over [0, n): key 0 is the most popular
+class ZipfKeys {
+public:
+    ZipfKeys(size_t n, double s, uint32_t seed) : cdf(n), rng(seed) {
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), s);
+            cdf[i] = sum;
+        }
+        for (auto& value : cdf) {
+            value /= sum;
+        }
+    }
+
+    uint64_t Next() {
+        size_t index = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+        return std::min(index, cdf.size() - 1);
+    }
+
+private:
+    std::vector<double> cdf;
+    std::mt19937 rng;
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+};
+
+void SingleFlightCacheBenchmark() {
+    // AsyncLazy: many concurrent awaiters, one computation
+    {
+        Scheduler scheduler;
+        int computed = 0;
+        AsyncLazy<int> lazy([&computed]() {
+            ++computed;
+            auto work = RunOnThreadPool<int>(SpinFor, std::chrono::microseconds(1000));
+            Await(work);
+            return 42;
+        });
+        int sum = 0;
+        for (int i = 0; i < 100; ++i) {
+            scheduler.CreateCoroutine<void>([&]() {
+                auto value = lazy.Get();
+                sum += Await(value);
+            });
+        }
+        scheduler.Run();
+        assert(computed == 1);
+        assert(sum == 42 * 100);
+    }
+
+    // A failed computation is not cached; the next request retries
+    {
+        Scheduler scheduler;
+        SingleFlightCache<int, int> cache;
+        int attempts = 0;
+        scheduler.CreateCoroutine<void>([&]() {
+            auto failed = cache.GetOrCompute(7, [&](int) -> int {
+                ++attempts;
+                throw std::runtime_error("transient failure");
+            });
+            while (!failed.GetPromise()->IsCompleted()) {
+                Coroutine::YieldExecution();
+            }
+            assert(failed.GetPromise()->HasException());
+
+            auto retried = cache.GetOrCompute(7, [&](int key) { ++attempts; return key * 3; });
+            int value = Await(retried);
+            assert(value == 21);
+        });
+        scheduler.Run();
+        assert(attempts == 2);
+    }
+
+    const size_t numCores = std::min<size_t>(4, std::max<size_t>(1, std::thread::hardware_concurrency()));
+    const size_t numClients = numCores * 16;
+    const int requestsPerClient = 200;
+    const size_t numKeys = 10000;
+
+    std::vector<std::vector<uint64_t>> keys(numClients);
+    std::unordered_set<uint64_t> distinctKeys;
+    for (size_t c = 0; c < numClients; ++c) {
+        ZipfKeys zipf(numKeys, 1.0, static_cast<uint32_t>(c + 1));
+        for (int i = 0; i < requestsPerClient; ++i) {
+            keys[c].push_back(zipf.Next());
+            distinctKeys.insert(keys[c].back());
+        }
+    }
+    const uint64_t totalRequests = numClients * requestsPerClient;
+
+    std::atomic<uint64_t> computations{0};
+    auto expensive = [&computations](uint64_t key) {
+        computations.fetch_add(1, std::memory_order_relaxed);
+        SpinFor(std::chrono::microseconds(100));
+        return key * 2;
+    };
+
+    auto runWorkload = [&](const char* label, SingleFlightCache<uint64_t, uint64_t>* cache) {
+        computations = 0;
+        std::vector<std::vector<double>> latencies(numClients);
+        double totalMs = 0.0;
+        {
+            CoreRuntime runtime(numCores);
+            std::vector<Task<int>> clients;
+            totalMs = MeasureMilliseconds([&]() {
+                for (size_t c = 0; c < numClients; ++c) {
+                    clients.push_back(runtime.SubmitTo<int>(c % numCores, [&, c]() {
+                        int wrong = 0;
+                        for (uint64_t key : keys[c]) {
+                            auto begin = std::chrono::steady_clock::now();
+                            Task<uint64_t> value = cache
+                                ? cache->GetOrCompute(key, [&](uint64_t k) {
+                                      auto work = RunOnThreadPool<uint64_t>(expensive, k);
+                                      return Await(work);
+                                  })
+                                : RunOnThreadPool<uint64_t>(expensive, key);
+                            wrong += Await(value) == key * 2 ? 0 : 1;
+                            latencies[c].push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+                        }
+                        return wrong;
+                    }));
+                }
+                for (auto& client : clients) {
+                    int wrong = Await(client);
+                    assert(wrong == 0);
+                }
+            });
+        }
+
+        std::vector<double> all;
+        for (auto& client : latencies) {
+            all.insert(all.end(), client.begin(), client.end());
+        }
+        std::sort(all.begin(), all.end());
+        double mean = 0.0;
+        for (double latency : all) {
+            mean += latency;
+        }
+        mean /= all.size();
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "\t" << std::left << std::setw(28) << label << std::right
+                  << computations.load() << " computations, amplification " << static_cast<double>(computations.load()) / distinctKeys.size()
+                  << ", mean " << mean << " us, p99 " << all[all.size() * 99 / 100] << " us, total " << totalMs << " ms" << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    };
+
+    std::cout << "\t" << totalRequests << " requests over " << distinctKeys.size() << " distinct keys (Zipf s=1.0, " << numCores << " cores)" << std::endl;
+    runWorkload("Uncached:", nullptr);
+
+    SingleFlightCache<uint64_t, uint64_t> unbounded(SingleFlightOptions{16, numKeys * 2});
+    runWorkload("Single-flight:", &unbounded);
+    SingleFlightStats stats = unbounded.Stats();
+    assert(computations == distinctKeys.size());
+    assert(stats.hits + stats.coalesced + stats.computations == totalRequests);
+    std::cout << "\t\t" << stats.hits << " hits, " << stats.coalesced << " joined an in-flight computation" << std::endl;
+
+    SingleFlightCache<uint64_t, uint64_t> bounded(SingleFlightOptions{16, 512, std::chrono::milliseconds(2)});
+    runWorkload("Single-flight, LRU 512, 2ms:", &bounded);
+    stats = bounded.Stats();
+    std::cout << "\t\t" << stats.evictions << " evictions, " << stats.expirations << " expirations" << std::endl;
+    assert(bounded.Size() <= 512);
+}
+
+void TaskGroupBenchmark() {
+    // The scope waits for its children, and a failing child cancels the siblings that poll
+    {
+        Scheduler scheduler;
+        int finishedChildren = 0;
+        int steps = 0;
+        bool failed = false;
+        auto bodyToken = std::make_shared<int>(0);
+        scheduler.CreateCoroutine<void>([&]() {
+            {
+                TaskGroup group;
+                group.SpawnMany(1000, [&](size_t) {
+                    Coroutine::YieldExecution();
+                    ++finishedChildren;
+                });
+            }
+            assert(finishedChildren == 1000);
+
+            auto observed = CreateTask<void>([&]() {
+                TaskGroup group;
+                group.SpawnMany(100, [&, token = bodyToken](size_t index) {
+                    if (index == 0) {
+                        throw std::runtime_error("child failed");
+                    }
+                    for (int i = 0; i < 1000 && !group.IsCancelled(); ++i) {
+                        ++steps;
+                        Coroutine::YieldExecution();
+                    }
+                });
+                group.Wait();
+            });
+            while (!observed.GetPromise()->IsCompleted()) {
+                Coroutine::YieldExecution();
+            }
+            failed = observed.GetPromise()->HasException();
+        });
+        scheduler.Run();
+        assert(failed);
+        assert(steps < 99 * 1000);
+        // The failed parent never reaches ~TaskGroup; Wait must have freed the shared body already
+        assert(bodyToken.use_count() == 1);
+        std::cout << "\tFirst error stopped the siblings after " << steps << " of " << 99 * 1000 << " steps" << std::endl;
+    }
+
+    // The parent parks while its children sleep instead of cycling through the run queue
+    {
+        static const TaskTag kParentTag{"group-parent"};
+        TaskProfiler::Enable();
+        {
+            Scheduler scheduler;
+            scheduler.CreateCoroutine<void>(kParentTag, []() {
+                TaskGroup group;
+                group.SpawnMany(4, [](size_t) { Scheduler::AsyncSleep(20); });
+                group.Wait();
+            });
+            scheduler.Run();
+        }
+        TaskProfiler::Disable();
+        uint64_t parentSlices = 0;
+        for (const TagProfile& profile : TaskProfiler::Snapshot()) {
+            if (std::string(profile.tag) == kParentTag.name) {
+                parentSlices = profile.slices;
+            }
+        }
+        assert(parentSlices > 0 && parentSlices <= 3);
+    }
+
+    for (size_t n : {size_t(1000), size_t(10000), size_t(100000), size_t(1000000)}) {
+        Scheduler scheduler;
+        double loopMs = 0.0;
+        double groupMs = 0.0;
+        uint64_t loopAllocations = 0;
+        uint64_t groupAllocations = 0;
+
+        scheduler.CreateCoroutine<void>([&]() {
+            uint64_t sum = 0;
+            uint64_t before = allocationCount.load(std::memory_order_relaxed);
+            loopMs = MeasureMilliseconds([&]() {
+                std::vector<Task<void>> children;
+                children.reserve(n);
+                for (size_t i = 0; i < n; ++i) {
+                    children.push_back(CreateTask<void>([&sum, i]() { sum += i; }));
+                }
+                for (auto& child : children) {
+                    Await(child);
+                }
+            });
+            loopAllocations = allocationCount.load(std::memory_order_relaxed) - before;
+            assert(sum == n * (n - 1) / 2);
+
+            sum = 0;
+            before = allocationCount.load(std::memory_order_relaxed);
+            groupMs = MeasureMilliseconds([&]() {
+                TaskGroup group;
+                group.SpawnMany(n, [&sum](size_t i) { sum += i; });
+                group.Wait();
+            });
+            groupAllocations = allocationCount.load(std::memory_order_relaxed) - before;
+            assert(sum == n * (n - 1) / 2);
+        });
+        scheduler.Run();
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "\t" << std::setw(7) << n << " children: CreateTask loop " << loopMs << " ms ("
+                  << static_cast<double>(loopAllocations) / n << " allocs/child), TaskGroup::SpawnMany " << groupMs << " ms ("
+                  << static_cast<double>(groupAllocations) / n << " allocs/child)" << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+        assert(groupAllocations * 10 < n);
+    }
+}
+
+// Runs one coroutine on this thread and one on a second thread, each with its own Scheduler
+static double RunOnTwoSchedulers(std::function<void()> local, std::function<void()> remote) {
+    return MeasureMilliseconds([&]() {
+        std::thread other([&]() {
+            Scheduler scheduler;
+            scheduler.CreateCoroutine<void>(remote);
+            scheduler.Run();
+        });
+        {
+            Scheduler scheduler;
+            scheduler.CreateCoroutine<void>(local);
+            scheduler.Run();
+        }
+        other.join();
+    });
+}
+
+void AsyncEventBenchmark() {
+    const int kRoundTrips = 20000;
+
+    // Fast paths: no waiters, or already signalled
+    {
+        AsyncAutoResetEvent event;
+        const int kOps = 1000000;
+        double fastMs = MeasureMilliseconds([&]() {
+            for (int i = 0; i < kOps; ++i) {
+                event.Set();
+                event.Wait();
+            }
+        });
+        std::cout << std::fixed << std::setprecision(1) << "\tUncontended Set+Wait: " << fastMs * 1e6 / kOps << " ns" << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+
+    // Signal-to-resume latency between coroutines on two scheduler threads, one signal per direction
+    std::atomic<int> turn{0};
+    double pollMs = RunOnTwoSchedulers([&]() {
+        for (int i = 0; i < kRoundTrips; ++i) {
+            turn.store(1, std::memory_order_release);
+            while (turn.load(std::memory_order_acquire) != 0) {
+                Coroutine::YieldExecution();
+            }
+        }
+    }, [&]() {
+        for (int i = 0; i < kRoundTrips; ++i) {
+            while (turn.load(std::memory_order_acquire) != 1) {
+                Coroutine::YieldExecution();
+            }
+            turn.store(0, std::memory_order_release);
+        }
+    });
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    int owner = 0;
+    double conditionMs = RunOnTwoSchedulers([&]() {
+        for (int i = 0; i < kRoundTrips; ++i) {
+            std::unique_lock<std::mutex> lock(mutex);
+            owner = 1;
+            changed.notify_one();
+            changed.wait(lock, [&] { return owner == 0; });
+        }
+    }, [&]() {
+        for (int i = 0; i < kRoundTrips; ++i) {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return owner == 1; });
+            owner = 0;
+            changed.notify_one();
+        }
+    });
+
+    AsyncAutoResetEvent ping;
+    AsyncAutoResetEvent pong;
+    int ticks = 0;
+    bool done = false;
+    double eventMs = RunOnTwoSchedulers([&]() {
+        // A sibling keeps running while the pinging coroutine is parked
+        CreateTask<void>([&]() {
+            while (!done) {
+                ++ticks;
+                Scheduler::AsyncSleep(1);
+            }
+        });
+        for (int i = 0; i < kRoundTrips; ++i) {
+            ping.Set();
+            pong.Wait();
+        }
+        done = true;
+    }, [&]() {
+        for (int i = 0; i < kRoundTrips; ++i) {
+            ping.Wait();
+            pong.Set();
+        }
+    });
+    assert(ticks > 0);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "\tSignal-to-resume across schedulers: YieldExecution polling " << pollMs * 1e6 / (2 * kRoundTrips)
+              << " ns, condition_variable " << conditionMs * 1e6 / (2 * kRoundTrips)
+              << " ns, AsyncAutoResetEvent " << eventMs * 1e6 / (2 * kRoundTrips) << " ns" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+
+    // Manual-reset event releases every waiter; a latch counted down by pool workers; a barrier across threads
+    {
+        AsyncManualResetEvent gate;
+        AsyncLatch workDone(64);
+        std::atomic<int> released{0};
+        std::atomic<int> phaseErrors{0};
+        int phases = 0;
+        int arrivals = 0;
+        AsyncBarrier barrier(4, [&]() {
+            if (arrivals != 4 * (phases + 1)) {
+                ++phaseErrors;
+            }
+            ++phases;
+        });
+        std::mutex arrivalMutex;
+
+        auto participant = [&]() {
+            for (int phase = 0; phase < 100; ++phase) {
+                {
+                    std::lock_guard<std::mutex> lock(arrivalMutex);
+                    ++arrivals;
+                }
+                barrier.ArriveAndWait();
+            }
+        };
+
+        RunOnTwoSchedulers([&]() {
+            for (int i = 0; i < 100; ++i) {
+                CreateTask<void>([&]() {
+                    gate.Wait();
+                    ++released;
+                });
+            }
+            CreateTask<void>(participant);
+            participant();
+            workDone.Wait();
+        }, [&]() {
+            for (int i = 0; i < 100; ++i) {
+                CreateTask<void>([&]() {
+                    gate.Wait();
+                    ++released;
+                });
+            }
+            CreateTask<void>(participant);
+            for (int i = 0; i < 64; ++i) {
+                RunOnThreadPool<void>([&]() { workDone.CountDown(); });
+            }
+            Scheduler::AsyncSleep(10);
+            gate.Set();
+            participant();
+        });
+
+        assert(released == 200);
+        assert(workDone.IsReady());
+        assert(phases == 100);
+        assert(phaseErrors == 0);
+        std::cout << "\tManual-reset event released " << released << " waiters, latch and " << phases << " barrier phases completed" << std::endl;
+    }
+}
+
 } // namespace TestCases
 
 int main() {
@@ -355,6 +2013,20 @@ int main() {
     testRunner->Register("Multi-Threaded Scheduler", TestCases::MultiThreadedScheduler);
     testRunner->Register("Hybrid Scheduling Benchmark", TestCases::HybridSchedulingBenchmark);
     testRunner->Register("StdMutexDeadlockTest", TestCases::StdMutexDeadlockTest);
+    testRunner->Register("Idle Policy Latency Benchmark", TestCases::IdlePolicyLatencyBenchmark);
+    testRunner->Register("Core Scaling Benchmark", TestCases::CoreScalingBenchmark);
+    testRunner->Register("Elastic Thread Pool Benchmark", TestCases::ElasticThreadPoolBenchmark);
+    testRunner->Register("Parallel Algorithms Benchmark", TestCases::ParallelAlgorithmsBenchmark);
+    testRunner->Register("Continuation Chain Benchmark", TestCases::ContinuationChainBenchmark);
+    testRunner->Register("Generator Benchmark", TestCases::GeneratorBenchmark);
+    testRunner->Register("Pipelined File Read Benchmark", TestCases::PipelinedFileReadBenchmark);
+    testRunner->Register("Policy Scheduler Benchmark", TestCases::PolicySchedulerBenchmark);
+    testRunner->Register("Hog Watchdog Benchmark", TestCases::HogWatchdogBenchmark);
+    testRunner->Register("Task Accounting Benchmark", TestCases::TaskAccountingBenchmark);
+    testRunner->Register("Logging Benchmark", TestCases::LoggingBenchmark);
+    testRunner->Register("Single-Flight Cache Benchmark", TestCases::SingleFlightCacheBenchmark);
+    testRunner->Register("Task Group Benchmark", TestCases::TaskGroupBenchmark);
+    testRunner->Register("Async Event Benchmark", TestCases::AsyncEventBenchmark);
 
     return testRunner->RunAll();
 }
\ No newline at end of file
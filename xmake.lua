@@ -17,9 +17,16 @@ target("coroutine")
     add_files(
         "src/coroutine.cpp",
         "src/scheduler.cpp",
-        "src/exception.cpp"
+        "src/exception.cpp",
+        "src/core.cpp",
+        "src/file.cpp",
+        "src/watchdog.cpp",
+        "src/log.cpp",
+        "src/taskgroup.cpp",
+        "src/event.cpp"
     )
     add_includedirs("include")
+    add_syslinks("synchronization", {public = true})
 
 target("benchmark")
     set_kind("binary")